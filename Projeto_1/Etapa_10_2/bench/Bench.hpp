@@ -0,0 +1,58 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <gtk/gtk.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "World.hpp"
+#include "Viewport.hpp"
+#include "FileHandlers.hpp"
+
+/*
+    Benchmarks: rodar com 'make bench' a partir da
+     pasta da Etapa [os arquivos vem de objs/].
+
+    Cada programa imprime o tempo medio por repetição,
+     medido com steady_clock depois de uma rodada de
+     aquecimento.
+*/
+
+// Adiciona os objetos de 'file' no mundo; retorna quantos foram adicionados
+int loadScene(World* world, Viewport* viewport, std::string file){
+    ObjReader r(file);
+    int n = 0;
+    for(auto obj : r.getObjs()){
+        try{
+            world->addObj(obj);
+            if(viewport != nullptr)
+                viewport->transformAndClipObj(obj);
+            n++;
+        }catch(MyException& e){
+            if(obj->getParent() != nullptr)
+                obj->getParent()->removeChild(obj);
+            delete obj;
+        }
+    }
+    return n;
+}
+
+// Tempo medio de 'f()' em milissegundos
+template<class F>
+double timeMs(int reps, F f){
+    f();
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0; i < reps; i++)
+        f();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1-t0).count()/reps;
+}
+
+// Evita que o compilador descarte um resultado não usado
+template<class T>
+void keep(const T& value){
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#endif // BENCH_HPP
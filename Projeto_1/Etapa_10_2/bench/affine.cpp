@@ -0,0 +1,54 @@
+#include <vector>
+#include "Bench.hpp"
+
+/*
+    Transformation [4x4] contra AffineTransformation [3x4]:
+     composição da cadeia T*Rx*Ry*Rz*S, um produto isolado e
+     a aplicação em 100k coordenadas.
+*/
+
+int main(){
+    const int reps = 200000;
+    double a = 0.0;
+
+    double full = timeMs(reps, [&]{
+        a += 0.001;
+        Transformation t = Transformation::newTranslation(a,2,3)*Transformation::newRx(a)*
+            Transformation::newRy(20)*Transformation::newRz(30)*Transformation::newScaling(2,2,2);
+        keep(t);
+    });
+    double affine = timeMs(reps, [&]{
+        a += 0.001;
+        AffineTransformation t = AffineTransformation::newTranslation(a,2,3)*AffineTransformation::newRx(a)*
+            AffineTransformation::newRy(20)*AffineTransformation::newRz(30)*AffineTransformation::newScaling(2,2,2);
+        keep(t);
+    });
+    printf("cadeia T*Rx*Ry*Rz*S: 4x4 %.1f ns, 3x4 %.1f ns\n", full*1e6, affine*1e6);
+
+    Transformation f1 = Transformation::newRotation(10,20,30), f2 = Transformation::newTranslation(1,2,3);
+    AffineTransformation a1 = AffineTransformation::newRotation(10,20,30),
+                         a2 = AffineTransformation::newTranslation(1,2,3);
+    full = timeMs(reps, [&]{ keep(f1); Transformation t = f1*f2; keep(t); });
+    affine = timeMs(reps, [&]{ keep(a1); AffineTransformation t = a1*a2; keep(t); });
+    printf("produto: 4x4 %.1f ns, 3x4 %.1f ns\n", full*1e6, affine*1e6);
+
+    const std::size_t n = 100000;
+    std::vector<Coordinate> in, out(n);
+    for(std::size_t i = 0; i < n; i++)
+        in.push_back(Coordinate(i%97, i%89, i%83));
+    Transformation f = a1.toTransformation();
+    full = timeMs(200, [&]{ f.apply(in.data(), out.data(), n); keep(out[0]); });
+    affine = timeMs(200, [&]{ a1.apply(in.data(), out.data(), n); keep(out[0]); });
+    printf("apply em %zu coordenadas: 4x4 %.3f ms, 3x4 %.3f ms\n", n, full, affine);
+
+    // Os dois caminhos devem dar o mesmo resultado
+    std::vector<Coordinate> check(n);
+    f.apply(in.data(), check.data(), n);
+    for(std::size_t i = 0; i < n; i++)
+        if(check[i].x != out[i].x || check[i].y != out[i].y ||
+           check[i].z != out[i].z || check[i].w != out[i].w){
+            printf("resultado diferente na coordenada %zu\n", i);
+            return 1;
+        }
+    return 0;
+}
@@ -0,0 +1,42 @@
+#include "Bench.hpp"
+
+/*
+    Tamanho das coordenadas normalizadas e tempo de
+     normalização + clipping [Viewport::update(), 1 thread]
+     com N copias do bowler.obj mais o cristo.obj.
+
+    Para comparar com coordenadas em double:
+     make -B bench BENCHFLAGS=-DNCOORDS_DOUBLE
+*/
+
+int main(){
+    printf("bandwidth: sizeof(NCoordinate) = %zu bytes\n", sizeof(NCoordinate));
+
+    for(int copies : {10, 100}){
+        World world;
+        Viewport viewport(500, 500, &world);
+        viewport.setThreads(1);
+        loadScene(&world, &viewport, "objs/cristo.obj");
+        loadScene(&world, &viewport, "objs/bowler.obj");
+        std::string src = world.getObj(world.numObjs()-1)->getName();
+        for(int i = 0; i < copies; i++){
+            Object* obj = world.addInstance(world.instanceName(src), src);
+            world.translateObj(obj->getName(), (i%10)*2.0, (i/10)*2.0, 0.0);
+            viewport.transformAndClipObj(obj);
+        }
+
+        double step = 1.0;
+        double ms = timeMs(20, [&]{
+            step = -step;
+            viewport.moveWindow(step, 0.0);
+            viewport.update();
+        });
+
+        std::size_t bytes = 0;
+        for(auto obj : world.getObjs())
+            bytes += obj->getNCoordsSize()*sizeof(NCoordinate);
+        printf("  %3d copias: %7.2f MB normalizados, %8.3f ms/quadro\n",
+               copies, bytes/(1024.0*1024.0), ms);
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <malloc.h>
+#include "Bench.hpp"
+
+/*
+    Memoria retida no heap depois de carregar cada arquivo
+     [mallinfo2: uordblks + hblkhd], com as coordenadas
+     normalizadas e recortadas pela viewport.
+
+    Uso: memory [arquivos...] [padrão: os .obj de objs/]
+*/
+
+static std::size_t heapBytes(){
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+int main(int argc, char** argv){
+    std::vector<std::string> files;
+    for(int i = 1; i < argc; i++)
+        files.push_back(argv[i]);
+    if(files.empty())
+        files = {"objs/bowler.obj", "objs/cristo.obj", "objs/basicman.obj",
+                 "objs/subzero.obj", "objs/BezierSurface.obj", "objs/BSplineSurface.obj"};
+
+    printf("%-26s %10s %8s %8s %10s\n", "arquivo", "KB", "faces", "linhas", "B/face");
+    for(const auto &file : files){
+        std::size_t before = heapBytes();
+        World *world = new World();
+        Viewport *viewport = new Viewport(500, 500, world);
+        loadScene(world, viewport, file);
+        std::size_t bytes = heapBytes() - before;
+
+        long faces = 0, lines = 0;
+        for(auto obj : world->getObjs()){
+            if(obj->getType() == ObjType::OBJECT3D)
+                faces += ((Object3D*) obj)->getFacesSize();
+            else if(obj->getType() == ObjType::BEZIER_SURFACE ||
+                    obj->getType() == ObjType::BSPLINE_SURFACE)
+                lines += ((Surface*) obj)->getIsoLines().size();
+        }
+        printf("%-26s %10.1f %8ld %8ld", file.c_str(), bytes/1024.0, faces, lines);
+        if(faces > 0)
+            printf(" %10.1f", (double) bytes/faces);
+        printf("\n");
+
+        delete viewport;
+        delete world;
+    }
+    return 0;
+}
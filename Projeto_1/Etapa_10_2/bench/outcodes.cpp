@@ -0,0 +1,60 @@
+#include <random>
+#include "Bench.hpp"
+
+/*
+    Codigos de região: getFrustumRC() coordenada por coordenada
+     contra computeRCs() em lote, e o clipping de linhas
+     aleatorias com cada algoritmo. Coordenadas em [-250,750]
+     contra a borda [12.5,487.5] da viewport 500x500.
+*/
+
+int main(){
+    const unsigned n = 1 << 20;
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dist(-250.0, 750.0);
+    NCoordinates coords;
+    for(unsigned i = 0; i < n; i++)
+        coords.emplace_back(dist(gen), dist(gen));
+
+    ClipWindow window(12.5, 487.5, 12.5, 487.5);
+    Clipping clipping(&window);
+    std::vector<unsigned char> rcs(n), single(n);
+
+    double one = timeMs(20, [&]{
+        for(unsigned i = 0; i < n; i++)
+            single[i] = clipping.getFrustumRC(coords[i]);
+        keep(single[0]);
+    });
+    double batch = timeMs(20, [&]{
+        clipping.computeRCs(coords.data(), n, rcs.data());
+        keep(rcs[0]);
+    });
+    printf("outcodes: getFrustumRC %.0f Mpts/s, computeRCs %.0f Mpts/s\n",
+           n/(one*1e3), n/(batch*1e3));
+    // O lote marca também o bit GUARD [32], que getFrustumRC() não tem
+    for(unsigned i = 0; i < n; i++)
+        if((rcs[i] & ~32) != single[i]){
+            printf("codigos diferentes na coordenada %u\n", i);
+            return 1;
+        }
+
+    Line line("bench", GdkRGBA({0,0,0}));
+    line.getNCoords().resize(2);
+    const unsigned lines = n/2;
+    const char* names[] = {"CS", "LB", "NLN"};
+    LineClipAlgs algs[] = {LineClipAlgs::CS, LineClipAlgs::LB, LineClipAlgs::NLN};
+    for(int a = 0; a < 3; a++){
+        clipping.setLineClipAlg(algs[a]);
+        unsigned visible = 0;
+        double ms = timeMs(5, [&]{
+            visible = 0;
+            for(unsigned i = 0; i < lines; i++){
+                line.getNCoord(0) = coords[2*i];
+                line.getNCoord(1) = coords[2*i+1];
+                visible += clipping.clip(&line);
+            }
+        });
+        printf("  linhas %-3s: %.1f Mlines/s [%u visiveis]\n", names[a], lines/(ms*1e3), visible);
+    }
+    return 0;
+}
@@ -0,0 +1,39 @@
+#include "Bench.hpp"
+
+/*
+    Sutherland-Hodgman [SH] contra o SH reentrante [SHR] nas
+     faces do bowler.obj, com o objeto escalado para que
+     parte das faces cruze a borda da window [em escala 1
+     ele tem uns 2 pixels de largura].
+     Tempo do Viewport::update() em 1 thread.
+*/
+
+int main(){
+    World world;
+    Viewport viewport(500, 500, &world);
+    viewport.setThreads(1);
+    loadScene(&world, &viewport, "objs/bowler.obj");
+    std::string name = world.getObj(0)->getName();
+
+    printf("polygon_clip: bowler.obj\n");
+    double scale = 1.0;
+    for(double target : {240.0, 400.0, 800.0}){
+        world.scaleObj(name, target/scale, target/scale, target/scale);
+        scale = target;
+        viewport.transformAndClipObj(world.getObj(0));
+
+        double ms[2];
+        PolygonClipAlgs algs[] = {PolygonClipAlgs::SH, PolygonClipAlgs::SHR};
+        for(int a = 0; a < 2; a++){
+            viewport.changePolygonClipAlg(algs[a]);
+            double step = 1.0;
+            ms[a] = timeMs(50, [&]{
+                step = -step;
+                viewport.moveWindow(step, 0.0);
+                viewport.update();
+            });
+        }
+        printf("  escala %3.0f: SH %.3f ms/quadro, SHR %.3f ms/quadro\n", scale, ms[0], ms[1]);
+    }
+    return 0;
+}
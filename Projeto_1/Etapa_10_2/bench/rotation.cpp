@@ -0,0 +1,56 @@
+#include <cmath>
+#include "Bench.hpp"
+#include "Window.hpp"
+
+/*
+    Custo por operação das rotações: cadeia de matrizes 4x4
+     Rx*Ry*Rz contra as rotações montadas por quaternions,
+     e a rotação + atualização da window.
+*/
+
+int main(){
+    const int reps = 200000;
+    double a = 0.0;
+
+    double chain = timeMs(reps, [&]{
+        a += 0.001;
+        Transformation t = Transformation::newRx(a)*Transformation::newRy(20)*Transformation::newRz(30);
+        keep(t);
+    });
+    double quat = timeMs(reps, [&]{
+        a += 0.001;
+        Transformation t = Transformation::newRotation(a, 20, 30);
+        keep(t);
+    });
+    double compose = timeMs(reps, [&]{
+        a += 0.001;
+        Quaternion q = Quaternion::newRotation(a, 20, 30);
+        keep(q);
+    });
+    printf("rotação xyz: Rx*Ry*Rz 4x4 %.1f ns, newRotation %.1f ns, so o quaternion %.1f ns\n",
+           chain*1e6, quat*1e6, compose*1e6);
+
+    Coordinate p(3, 4, 5);
+    double ra = timeMs(reps, [&]{ a += 0.001; Transformation t = Transformation::newRa(a, p); keep(t); });
+    double full = timeMs(reps, [&]{
+        a += 0.001;
+        Transformation t = Transformation::newFullRotation(a, 20, 30, 40, p);
+        keep(t);
+    });
+    printf("newRa %.1f ns, newFullRotation %.1f ns\n", ra*1e6, full*1e6);
+
+    Window window(500, 500);
+    double update = timeMs(reps, [&]{ window.updateTransformation(); keep(window.getT()); });
+    double step = timeMs(reps, [&]{ window.rotate(1, Coordinate(0, 1, 0)); keep(window.getOrientation()); });
+    printf("window: updateTransformation %.1f ns, rotate %.1f ns\n", update*1e6, step*1e6);
+
+    // As duas formas devem descrever a mesma rotação
+    Transformation t1 = Transformation::newRx(10)*Transformation::newRy(20)*Transformation::newRz(30);
+    Transformation t2 = Transformation::newRotation(10, 20, 30);
+    double diff = 0.0;
+    for(int i = 0; i < M_SIZE; i++)
+        for(int j = 0; j < M_SIZE; j++)
+            diff = std::max(diff, std::fabs(t1.getM()[i][j] - t2.getM()[i][j]));
+    printf("maior diferença entre as matrizes: %g\n", diff);
+    return diff < 1e-12 ? 0 : 1;
+}
@@ -0,0 +1,45 @@
+#include <thread>
+#include "Bench.hpp"
+
+/*
+    Escalabilidade da normalização + clipping [Viewport::update()]
+     de 1 até N threads. A cena tem 64 instancias do bowler.obj
+     em grade, com parte delas cruzando a borda da window.
+
+    Uso: threads [N] [padrão: std::thread::hardware_concurrency()]
+*/
+
+int main(int argc, char** argv){
+    World world;
+    Viewport viewport(500, 500, &world);
+    loadScene(&world, &viewport, "objs/bowler.obj");
+    std::string src = world.getObj(0)->getName();
+    for(int i = 0; i < 64; i++){
+        Object* obj = world.addInstance(world.instanceName(src), src);
+        world.translateObj(obj->getName(), (i%8)*80.0 - 300.0, (i/8)*80.0 - 300.0, 0.0);
+        world.scaleObj(obj->getName(), 20.0, 20.0, 20.0);
+        viewport.transformAndClipObj(obj);
+    }
+
+    unsigned maxThreads = argc > 1 ? atoi(argv[1]) : std::thread::hardware_concurrency();
+    std::vector<unsigned> counts;
+    for(unsigned t = 1; t < maxThreads; t *= 2)
+        counts.push_back(t);
+    counts.push_back(maxThreads > 0 ? maxThreads : 1);
+
+    printf("threads: %d objetos\n", world.numObjs());
+    double serial = 0.0, step = 1.0;
+    for(unsigned t : counts){
+        viewport.setThreads(t);
+        // A window vai e volta: todas as rodadas veem a mesma cena
+        double ms = timeMs(20, [&]{
+            step = -step;
+            viewport.moveWindow(step, 0.0);
+            viewport.update();
+        });
+        if(t == 1)
+            serial = ms;
+        printf("  %2u thread(s): %8.3f ms/quadro  %5.2fx\n", t, ms, serial/ms);
+    }
+    return 0;
+}
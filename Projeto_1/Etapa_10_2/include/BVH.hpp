@@ -0,0 +1,158 @@
+#ifndef BVH_HPP
+#define BVH_HPP
+
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include "Objects.hpp"
+
+/**
+ * Bounding Volume Hierarchy sobre as bounding boxes
+ *  (em coordenadas do mundo) dos objetos.
+ *  Usada pelo Viewport para descartar objetos inteiros
+ *  que estão fora da window antes de normaliza-los.
+ *
+ *  build: O(n log n)
+ *  refit: O(log n) [depois de transformar um objeto]
+ **/
+class BVH
+{
+    public:
+        BVH() {}
+        virtual ~BVH() {}
+
+        void build(const std::vector<Object*>& objs);
+        void refit(Object* obj);
+
+        // 'test' recebe uma BoundingBox e retorna se ela pode
+        //  ser visivel; 'visit' eh chamada para cada objeto
+        //  cujas boxes passaram no teste
+        template<class Test, class Visit>
+        void query(Test test, Visit visit) const;
+
+    private:
+        struct Node
+        {
+            BoundingBox box;
+            int left, right, parent;
+            Object* obj;// Apenas nas folhas
+        };
+
+        int buildNode(std::vector<Object*>& objs, int begin, int end, int parent);
+
+    private:
+        std::vector<Node> m_nodes;// m_nodes[0] eh a raiz
+        std::unordered_map<Object*, int> m_leaves;// Objeto -> folha
+};
+
+void BVH::build(const std::vector<Object*>& objs){
+    m_nodes.clear();
+    m_leaves.clear();
+
+    std::vector<Object*> tmp;
+    tmp.reserve(objs.size());
+    for(auto obj : objs)
+        if(!obj->bounds().empty())
+            tmp.push_back(obj);
+
+    if(tmp.size() == 0)
+        return;
+
+    m_nodes.reserve(2*tmp.size());
+    buildNode(tmp, 0, tmp.size(), -1);
+}
+
+int BVH::buildNode(std::vector<Object*>& objs, int begin, int end, int parent){
+    int index = m_nodes.size();
+    m_nodes.push_back(Node{BoundingBox(), -1, -1, parent, nullptr});
+
+    if(end - begin == 1){
+        Node &leaf = m_nodes[index];
+        leaf.obj = objs[begin];
+        leaf.box.clear();
+        leaf.box.add(leaf.obj->bounds());
+        m_leaves[leaf.obj] = index;
+        return index;
+    }
+
+    // Divide pela mediana dos centros, no maior eixo
+    BoundingBox centers;
+    centers.clear();
+    for(int i = begin; i < end; i++){
+        const BoundingBox &b = objs[i]->bounds();
+        centers.add(Coordinate((b.min.x+b.max.x)/2, (b.min.y+b.max.y)/2,
+                               (b.min.z+b.max.z)/2));
+    }
+    double dx = centers.max.x - centers.min.x,
+           dy = centers.max.y - centers.min.y,
+           dz = centers.max.z - centers.min.z;
+    int axis = (dx >= dy && dx >= dz) ? 0 : (dy >= dz ? 1 : 2);
+
+    auto key = [axis](const Object* obj){
+        const BoundingBox &b = obj->bounds();
+        if(axis == 0) return b.min.x + b.max.x;
+        if(axis == 1) return b.min.y + b.max.y;
+        return b.min.z + b.max.z;
+    };
+
+    int mid = (begin + end)/2;
+    std::nth_element(objs.begin()+begin, objs.begin()+mid, objs.begin()+end,
+                     [&key](const Object* a, const Object* b){ return key(a) < key(b); });
+
+    int left = buildNode(objs, begin, mid, index);
+    int right = buildNode(objs, mid, end, index);
+
+    Node &node = m_nodes[index];
+    node.left = left;
+    node.right = right;
+    node.box.clear();
+    node.box.add(m_nodes[left].box);
+    node.box.add(m_nodes[right].box);
+    return index;
+}
+
+void BVH::refit(Object* obj){
+    auto iter = m_leaves.find(obj);
+    if(iter == m_leaves.end())
+        return;
+
+    int index = iter->second;
+    m_nodes[index].box.clear();
+    m_nodes[index].box.add(obj->bounds());
+
+    index = m_nodes[index].parent;
+    while(index != -1){
+        Node &node = m_nodes[index];
+        node.box.clear();
+        node.box.add(m_nodes[node.left].box);
+        node.box.add(m_nodes[node.right].box);
+        index = node.parent;
+    }
+}
+
+template<class Test, class Visit>
+void BVH::query(Test test, Visit visit) const {
+    if(m_nodes.size() == 0)
+        return;
+
+    // A arvore eh dividida pela mediana, então a altura eh
+    //  log2(n) e a pilha nunca passa de altura+1 nós
+    int stack[64];
+    int size = 0;
+    stack[size++] = 0;
+    while(size != 0){
+        const Node &node = m_nodes[stack[--size]];
+
+        if(!test(node.box))
+            continue;
+
+        if(node.obj != nullptr){
+            visit(node.obj);
+        }else{
+            stack[size++] = node.right;
+            stack[size++] = node.left;
+        }
+    }
+}
+
+#endif // BVH_HPP
@@ -1,7 +1,17 @@
 #ifndef CLIPPING_HPP
 #define CLIPPING_HPP
 
+#include <chrono>
+#include <cstring>
+#include <limits>
 #include "Objects.hpp"
+#include "FrameArena.hpp"
+
+// Codigos de região de 4 coordenadas [float] por vez
+#if defined(__SSE2__) && !defined(NCOORDS_DOUBLE)
+    #include <emmintrin.h>
+    #define CLIPPING_SIMD
+#endif
 
 /**
  * Retangulo delimitando a window para podermos ver
@@ -12,16 +22,33 @@ public:
     ClipWindow(double minX_, double maxX_, double minY_, double maxY_);
     void addCoordinate(double x, double y) {m_coords.emplace_back(x,y);
                                             m_nCoords.emplace_back(x,y);}
+    // Na perspectiva o clipping também usa o plano near [em w]
+    void setPerspective(bool perspective, double nearW);
+    // Guard band: a window aumentada 'marginX' e 'marginY' em cada
+    //  lado. O que fica dentro dela não precisa de clipping [0: sem]
+    void setGuardBand(double marginX, double marginY);
 
     double minX, maxX, minY, maxY;
+    double guardMinX, guardMaxX, guardMinY, guardMaxY;
+    bool perspective = false;
+    double nearW = 0;
 };
 
 /**
- * Enumeração dos dois algoritmos de clipping de linhas.
- *      CS = Cohen Sutherland
- *      LB = Liang Basky
+ * Enumeração dos algoritmos de clipping de linhas.
+ *      CS   = Cohen Sutherland
+ *      LB   = Liang Basky
+ *      NLN  = Nicholl Lee Nicholl
+ *      AUTO = O mais rapido nas linhas da cena [ver calibrate()]
+ **/
+enum class LineClipAlgs { CS, LB, NLN, AUTO };
+
+/**
+ * Enumeração dos dois algoritmos de clipping de poligonos.
+ *      SH  = Sutherland Hodgman, uma passada por borda
+ *      SHR = Sutherland Hodgman reentrante, uma passada só
  **/
-enum class LineClipAlgs { CS, LB };
+enum class PolygonClipAlgs { SH, SHR };
 
 class Clipping
 {
@@ -31,116 +58,551 @@ class Clipping
         virtual ~Clipping() {}
 
         void setLineClipAlg(const LineClipAlgs alg){ m_current = alg; }
-
+        LineClipAlgs getLineClipAlg() const { return m_current; }
+        void setPolygonClipAlg(const PolygonClipAlgs alg){ m_polygonAlg = alg; }
+        // Libera todos os buffers temporarios do quadro
+        void resetArena(){ m_arena.reset(); }
+
+        // Na perspectiva as coordenadas chegam homogêneas, com o w
+        //  no lugar do z: a divisão e o clipping contra o plano near
+        //  acontecem aqui, antes do clipping 2D
         bool clip(Object* obj);
+        // Versões sem o switch, para quem ja sabe o tipo do objeto
+        bool clip(Point* p);
+        bool clip(Line* l);
+        bool clip(Polygon* p){ return clipPolygon(p); }
+        bool clip(Curve* c){ return clipCurve(c); }
+        bool clip(Object3D* obj);
+        bool clip(Surface* surf);
+        // Clipping só das faces [iso-linhas] [first, last), adicionado
+        //  ao final de 'coords' e 'faces' ['lines']. Usado para dividir
+        //  objetos grandes entre threads; 'first' das faces não indexadas
+        //  [e das linhas] se refere a 'coords'
+        void clip(Object3D* obj, unsigned first, unsigned last,
+                  NCoordinates& coords, ClippedFaces& faces);
+        void clip(Surface* surf, unsigned first, unsigned last,
+                  NCoordinates& coords, IsoLines& lines);
+
+        // Prepara os vertices [first, first+size) recem normalizados
+        //  para as versões de faixa do clip(): divisão perspectiva e,
+        //  nos Object3D fora de isInsideWindow(), os codigos de região
+        void prepare(Object* obj, unsigned first, unsigned size);
+        // Divide por w os vertices na frente do plano near [o z
+        //  continua com o w]; os de trás ficam homogêneos
+        void project(NCoordinate* coords, unsigned size);
+        // Codigo de região de um vertice do frustum [dividido ou
+        //  homogêneo, ver project()], com o bit do plano near
+        int getFrustumRC(const NCoordinate& c);
+        // getFrustumRC() de 'size' coordenadas de uma vez
+        void computeRCs(const NCoordinate* coords, unsigned size, unsigned char* rcs);
+
+        // Calibração do modo AUTO: depois de startCalibration() os
+        //  segmentos que chegam aos algoritmos [os que cruzam a borda]
+        //  são guardados, até CALIBRATION_SAMPLES. calibrate() mede
+        //  cada algoritmo nas amostras e devolve o mais rapido, que
+        //  passa a ser usado pelo AUTO [setAutoLineClipAlg()]
+        void startCalibration(){ m_lineSamples.clear(); m_sampling = true; }
+        bool isCalibrating() const { return m_sampling; }
+        const NCoordinates& getLineSamples() const { return m_lineSamples; }
+        LineClipAlgs calibrate(const NCoordinates& samples);
+        void setAutoLineClipAlg(const LineClipAlgs alg){ m_sampling = false; m_auto = alg; }
+
+        // Sutherland-Hodgman reentrante: cada vertice ['in(i)', i em
+        //  [0, size)] passa pelas 4 bordas em sequencia, com o estado
+        //  de cada borda na pilha. A saida vai para 'out', com espaço
+        //  para 'capacity' vertices; devolve o numero de vertices
+        //  [maior que 'capacity' se não couber]. Não aloca nada
+        template<class Input>
+        unsigned ReentrantPolygonClip(const Input& in, unsigned size,
+                                      NCoordinate* out, unsigned capacity) const;
 
     private:
-        bool clipPoint(const Coordinate& c);
-        bool clipLine(Coordinate& c1, Coordinate& c2);
-        bool clipPolygon(Object* p)
-            {return SutherlandHodgmanPolygonClip(p);}
-        bool clipCurve(Object *obj);
-
-        int getCoordRC(const Coordinate& c);
-        bool CohenSutherlandLineClip(Coordinate& c1, Coordinate& c2);
-        bool LiangBaskyLineClip(Coordinate& c1, Coordinate& c2);
-        bool SutherlandHodgmanPolygonClip(Object* p);
-
-        void clipLeft(Coordinates& input, Coordinates& output);
-        void clipRight(Coordinates& input, Coordinates& output);
-        void clipTop(Coordinates& input, Coordinates& output);
-        void clipBottom(Coordinates& input, Coordinates& output);
+        bool clipPoint(const NCoordinate& c);
+        bool clipLine(NCoordinate& c1, NCoordinate& c2);
+        bool clipPolygon(Object* p);
+        bool clipCurve(Curve *curve);
+        // Clipping de um caminho aberto, adicionado ao final de 'output'.
+        //  Cada trecho visivel [o caminho quebra onde sai da window]
+        //  vai para 'paths', com os indices em 'output'
+        template<class Output>
+        void clipPath(const NCoordinate* coords, unsigned size,
+                      Output& output, IsoLines& paths);
+
+        int getCoordRC(const NCoordinate& c);
+        // RC::GUARD se 'c' esta fora da guard band. Sem a guard band
+        //  ela eh a propria window: todo vertice fora tem o bit
+        int getGuardRC(const NCoordinate& c);
+        bool CohenSutherlandLineClip(NCoordinate& c1, NCoordinate& c2, int rc1, int rc2);
+        bool LiangBaskyLineClip(NCoordinate& c1, NCoordinate& c2);
+        bool NichollLeeNichollLineClip(NCoordinate& c1, NCoordinate& c2, int rc1, int rc2);
+        // Segmento ambiguo [nem todo dentro, nem todo fora] com 'alg'
+        bool runLineClip(LineClipAlgs alg, NCoordinate& c1, NCoordinate& c2, int rc1, int rc2);
+        bool SutherlandHodgmanPolygonClip(NCoordinates& input);
+        // Algoritmo escolhido, com o resultado em 'coords'
+        bool clipPolygonCoords(NCoordinates& coords);
+        // ReentrantPolygonClip() para m_polygonOut. Falso se não coube
+        template<class Input>
+        bool clipReentrant(const Input& in, unsigned size, unsigned& outSize);
+
+        // Estado de uma borda do Sutherland-Hodgman reentrante
+        struct SHEdge
+        {
+            NCoordinate first, prev;
+            bool started = false;
+        };
+        struct SHOutput
+        {
+            NCoordinate* data;
+            unsigned size, capacity;
+        };
+        // Bordas na ordem do SH: 0 esquerda, 1 direita, 2 baixo e
+        //  3 cima. shVertex<4> eh a saida
+        template<int E>
+        bool insideEdge(const NCoordinate& c) const;
+        template<int E>
+        NCoordinate intersectEdge(const NCoordinate& c0, const NCoordinate& c1) const;
+        template<int E>
+        void shVertex(SHEdge* edges, const NCoordinate& c, SHOutput& out) const;
+        template<int E>
+        void shClose(SHEdge* edges, SHOutput& out) const;
+
+        // 'input' e 'output' podem vir da arena ou não
+        template<class Input, class Output>
+        void clipLeft(Input& input, Output& output);
+        template<class Input, class Output>
+        void clipRight(Input& input, Output& output);
+        template<class Input, class Output>
+        void clipTop(Input& input, Output& output);
+        template<class Input, class Output>
+        void clipBottom(Input& input, Output& output);
+
+        // Plano near: os vertices ja passaram por project()
+        bool inFront(const NCoordinate& c) const { return c.z >= m_w->nearW; }
+        // Ponto, ja dividido, onde a aresta a-b cruza o plano near
+        NCoordinate nearIntersection(const NCoordinate& a, const NCoordinate& b);
+        bool clipNear(NCoordinate& c1, NCoordinate& c2);
+        bool clipNear(NCoordinates& polygon);
+        // Chama 'run' com cada parte do caminho na frente do plano near
+        template<class Run>
+        void forEachNearRun(const NCoordinate* coords, unsigned size, Run run);
 
     private:
         const ClipWindow* m_w;
         LineClipAlgs m_current = LineClipAlgs::CS;
-
-        enum RC {INSIDE=0, LEFT=1, RIGHT=2, BOTTOM=4, TOP=8};
+        LineClipAlgs m_auto = LineClipAlgs::CS;// Usado pelo AUTO
+
+        // Amostras da calibração, em pares [c1, c2]
+        bool m_sampling = false;
+        NCoordinates m_lineSamples;
+        // Segmentos visiveis nas medições: usados só para o
+        //  compilador não descartar as contas
+        unsigned m_calibrationHits = 0;
+        enum { CALIBRATION_SAMPLES = 2048, CALIBRATION_REPS = 5 };
+        PolygonClipAlgs m_polygonAlg = PolygonClipAlgs::SHR;
+
+        NCoordinates m_face;// Usada no clipping das faces dos objetos 3D
+        NCoordinates m_polygonOut;// Saida do SH reentrante [só cresce]
+        // Buffers temporarios do clipping [uma arena por
+        //  Clipping, e um Clipping por thread]
+        FrameArena m_arena;
+
+        // GUARD só aparece nos codigos de computeRCs(). Aceito sem
+        //  clipping: nenhum vertice com GUARD ou NEAR. Rejeitado: todos
+        //  fora do mesmo lado da window [os bits sem o GUARD]
+        enum RC {INSIDE=0, LEFT=1, RIGHT=2, BOTTOM=4, TOP=8, NEAR=16, GUARD=32};
 };
 
+template<>
+void Clipping::shVertex<4>(SHEdge* edges, const NCoordinate& c, SHOutput& out) const {
+    if(out.size < out.capacity)
+        out.data[out.size] = c;
+    out.size++;
+}
+
+template<>
+void Clipping::shClose<4>(SHEdge* edges, SHOutput& out) const {}
+
 ClipWindow::ClipWindow(double minX_, double maxX_, double minY_, double maxY_):
         Polygon("_border_", GdkRGBA({0,0.9,0})) {
 
-    minX = minX_; maxX = maxX_;
-    minY = minY_; maxY = maxY_;
+    // Limites com a precisão das coordenadas normalizadas: um ponto
+    //  levado para a borda fica exatamente sobre ela
+    NCoordinate lo(minX_, minY_), hi(maxX_, maxY_);
+    minX = lo.x; maxX = hi.x;
+    minY = lo.y; maxY = hi.y;
 
     addCoordinate(minX,minY);
     addCoordinate(maxX,minY);
     addCoordinate(maxX,maxY);
     addCoordinate(minX,maxY);
+    setGuardBand(0, 0);
+}
+
+void ClipWindow::setPerspective(bool perspective_, double nearW_){
+    perspective = perspective_;
+    // Com a precisão das coordenadas, como os limites: um ponto
+    //  levado para o plano near não fica atras dele
+    nearW = NCoordinate(0, 0, nearW_).z;
+}
+
+void ClipWindow::setGuardBand(double marginX, double marginY){
+    // Com a precisão das coordenadas, como os limites
+    NCoordinate lo(minX - marginX, minY - marginY), hi(maxX + marginX, maxY + marginY);
+    guardMinX = lo.x; guardMaxX = hi.x;
+    guardMinY = lo.y; guardMaxY = hi.y;
 }
 
 bool Clipping::clip(Object* obj){
     switch(obj->getType()){
     case ObjType::OBJECT:
+    case ObjType::GROUP:
         break;
     case ObjType::POINT:
-        return clipPoint(obj->getNCoord(0));
+        return clip((Point*) obj);
     case ObjType::LINE:
-        return clipLine(obj->getNCoord(0), obj->getNCoord(1));
+        return clip((Line*) obj);
     case ObjType::POLYGON:
-        return clipPolygon(obj);
+        return clip((Polygon*) obj);
     case ObjType::BEZIER_CURVE:
     case ObjType::BSPLINE_CURVE:
-        return clipCurve(obj);
-    case ObjType::OBJECT3D:{
-        Object3D *obj3d = (Object3D*) obj;
-        bool draw = false;
-        for(auto &face : obj3d->getFaceList()){
-            bool tmp = clipPolygon(&face);
-            if(!tmp){ face.getNCoords().clear(); }
-            draw |= tmp;
-        }
-        return draw;
-    }case ObjType::BEZIER_SURFACE:
-    case ObjType::BSPLINE_SURFACE:{
-        Surface *surf = (Surface*) obj;
-        bool draw = false;
-        for(auto &curve : surf->getCurveList()){
-            bool tmp = clipCurve(&curve);
-            if(!tmp){ curve.getNCoords().clear(); }
-            draw |= tmp;
-        }
-        return draw;
-    }}
+        return clip((Curve*) obj);
+    case ObjType::OBJECT3D:
+        return clip((Object3D*) obj);
+    case ObjType::BEZIER_SURFACE:
+    case ObjType::BSPLINE_SURFACE:
+        return clip((Surface*) obj);
+    }
     return false;
 }
 
-bool Clipping::clipPoint(const Coordinate& c){
-    return c.x >= m_w->minX && c.x <= m_w->maxX &&
-                c.y >= m_w->minY && c.y <= m_w->maxY;
+void Clipping::prepare(Object* obj, unsigned first, unsigned size){
+    NCoordinate *coords = obj->getNCoords().data() + first;
+    if(m_w->perspective)
+        project(coords, size);
+    if(obj->getType() == ObjType::OBJECT3D && !obj->isInsideWindow())
+        computeRCs(coords, size, ((Object3D*) obj)->getRegionCodes().data() + first);
 }
 
-bool Clipping::clipLine(Coordinate& c1, Coordinate& c2){
-    if(m_current == LineClipAlgs::CS)
-        return CohenSutherlandLineClip(c1,c2);
-    else
-        return LiangBaskyLineClip(c1,c2);
+bool Clipping::clip(Point* p){
+    if(m_w->perspective){
+        project(&p->getNCoord(0), 1);
+        if(!inFront(p->getNCoord(0)))
+            return false;
+    }
+    return clipPoint(p->getNCoord(0));
 }
 
-//https://en.wikipedia.org/wiki/Cohen%E2%80%93Sutherland_algorithm
-int Clipping::getCoordRC(const Coordinate& c){
-    int rc = Clipping::RC::INSIDE;
+bool Clipping::clip(Line* l){
+    NCoordinate &c1 = l->getNCoord(0), &c2 = l->getNCoord(1);
+    if(m_w->perspective){
+        project(&c1, 2);
+        if(!clipNear(c1, c2))
+            return false;
+    }
+    return clipLine(c1, c2);
+}
+
+bool Clipping::clipPolygon(Object* p){
+    auto &coords = p->getNCoords();
+    if(m_w->perspective)
+        project(coords.data(), coords.size());
+
+    // Todos os vertices dentro [ou fora do mesmo lado]: nem
+    //  passa pelo Sutherland-Hodgman
+    ArenaVector<unsigned char> rcs(coords.size(), 0, m_arena);
+    computeRCs(coords.data(), coords.size(), rcs.data());
+    int allRC = ~0, anyRC = 0;
+    for(auto rc : rcs){
+        allRC &= rc;
+        anyRC |= rc;
+    }
+    if((allRC & ~Clipping::RC::GUARD) != 0)
+        return false;
+    if((anyRC & (Clipping::RC::GUARD | Clipping::RC::NEAR)) == 0)
+        return coords.size() != 0;
+
+    if((anyRC & Clipping::RC::NEAR) && !clipNear(coords))
+        return false;
+    return clipPolygonCoords(coords);
+}
+
+bool Clipping::clip(Surface* surf){
+    prepare(surf, 0, surf->getNCoords().size());
+    // Toda dentro da window: as iso-linhas são desenhadas sem clipping
+    if(surf->isInsideWindow())
+        return surf->getIsoLines().size() != 0;
+
+    auto &clippedCoords = surf->getClippedCoords();
+    auto &clippedLines = surf->getClippedLines();
+    clippedCoords.clear();
+    clippedLines.clear();
+
+    clip(surf, 0, surf->getIsoLines().size(), clippedCoords, clippedLines);
+    return clippedLines.size() != 0;
+}
 
-    if(c.x < m_w->minX)
+void Clipping::clip(Surface* surf, unsigned first, unsigned last,
+                    NCoordinates& clippedCoords, IsoLines& clippedLines){
+    const auto &coords = surf->getNCoords();
+    const auto &lines = surf->getIsoLines();
+
+    for(unsigned l = first; l < last; l++){
+        const IsoLine &line = lines[l];
+        if(m_w->perspective){
+            // Cada parte na frente do plano near vira uma linha
+            forEachNearRun(coords.data()+line.first, line.size,
+                [&](const NCoordinate* part, unsigned size){
+                    clipPath(part, size, clippedCoords, clippedLines);
+                });
+            continue;
+        }
+
+        clipPath(coords.data()+line.first, line.size, clippedCoords, clippedLines);
+    }
+}
+
+void Clipping::project(NCoordinate* coords, unsigned size){
+    for(unsigned i = 0; i < size; i++){
+        NCoordinate &c = coords[i];
+        if(inFront(c)){
+            c.x /= c.z;
+            c.y /= c.z;
+        }
+    }
+}
+
+void Clipping::computeRCs(const NCoordinate* coords, unsigned size, unsigned char* rcs){
+    unsigned i = 0;
+#ifdef CLIPPING_SIMD
+    static_assert(sizeof(NCoordinate) == 3*sizeof(float), "NCoordinate precisa ser 3 floats");
+
+    const __m128 minX = _mm_set1_ps(m_w->minX), maxX = _mm_set1_ps(m_w->maxX);
+    const __m128 minY = _mm_set1_ps(m_w->minY), maxY = _mm_set1_ps(m_w->maxY);
+    // Na projeção paralela o z eh o z mesmo: nenhum fica atras
+    const __m128 nearW = _mm_set1_ps(m_w->perspective ? (float) m_w->nearW :
+                                        -std::numeric_limits<float>::infinity());
+    const __m128i left = _mm_set1_epi32(RC::LEFT), right = _mm_set1_epi32(RC::RIGHT);
+    const __m128i bottom = _mm_set1_epi32(RC::BOTTOM), top = _mm_set1_epi32(RC::TOP);
+    const __m128i nearBit = _mm_set1_epi32(RC::NEAR);
+    const __m128 guardMinX = _mm_set1_ps(m_w->guardMinX), guardMaxX = _mm_set1_ps(m_w->guardMaxX);
+    const __m128 guardMinY = _mm_set1_ps(m_w->guardMinY), guardMaxY = _mm_set1_ps(m_w->guardMaxY);
+    const __m128i guardBit = _mm_set1_epi32(RC::GUARD);
+
+    int anyNear = 0;
+    const float *f = &coords[0].x;
+    for(; i+4 <= size; i += 4, f += 12){
+        // 4 coordenadas [x y z] seguidas: separa os x, y e z
+        __m128 a = _mm_loadu_ps(f), b = _mm_loadu_ps(f+4), c = _mm_loadu_ps(f+8);
+        __m128 x = _mm_shuffle_ps(a, _mm_shuffle_ps(b, c, _MM_SHUFFLE(1,1,2,2)), _MM_SHUFFLE(2,0,3,0));
+        __m128 y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0,0,1,1)),
+                                  _mm_shuffle_ps(b, c, _MM_SHUFFLE(2,2,3,3)), _MM_SHUFFLE(2,0,2,0));
+        __m128 z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1,1,2,2)),
+                                  _mm_shuffle_ps(c, c, _MM_SHUFFLE(3,3,0,0)), _MM_SHUFFLE(2,0,2,0));
+
+        __m128i rc = _mm_or_si128(
+            _mm_or_si128(_mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(x, minX)), left),
+                         _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(x, maxX)), right)),
+            _mm_or_si128(_mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(y, minY)), bottom),
+                         _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(y, maxY)), top)));
+        rc = _mm_or_si128(rc, _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(z, nearW)), nearBit));
+        __m128 guard = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(x, guardMinX), _mm_cmpgt_ps(x, guardMaxX)),
+                                 _mm_or_ps(_mm_cmplt_ps(y, guardMinY), _mm_cmpgt_ps(y, guardMaxY)));
+        rc = _mm_or_si128(rc, _mm_and_si128(_mm_castps_si128(guard), guardBit));
+
+        rc = _mm_packs_epi32(rc, rc);
+        rc = _mm_packus_epi16(rc, rc);
+        int packed = _mm_cvtsi128_si32(rc);
+        std::memcpy(rcs+i, &packed, 4);
+        anyNear |= packed;
+    }
+
+    // Vertices atras do plano near: os planos laterais
+    //  são testados nas coordenadas homogêneas [sem o GUARD,
+    //  o NEAR ja impede que sejam aceitos]
+    if(anyNear & 0x10101010)
+        for(unsigned j = 0; j < i; j++)
+            if(rcs[j] & RC::NEAR)
+                rcs[j] = getFrustumRC(coords[j]);
+#endif
+    for(; i < size; i++){
+        int rc = getFrustumRC(coords[i]);
+        rcs[i] = (rc & RC::NEAR) ? rc : rc | getGuardRC(coords[i]);
+    }
+}
+
+int Clipping::getFrustumRC(const NCoordinate& c){
+    if(!m_w->perspective || inFront(c))
+        return getCoordRC(c);
+
+    // Homogêneo: os planos laterais passam pelo centro de projeção
+    //  [x = minX*w, ...]. Com w negativo os dois lados de um eixo
+    //  podem valer ao mesmo tempo, por isso não há 'else'
+    int rc = Clipping::RC::NEAR;
+    double w = c.z;
+    if(c.x < m_w->minX*w)
         rc |= Clipping::RC::LEFT;
-    else if(c.x > m_w->maxX)
+    if(c.x > m_w->maxX*w)
         rc |= Clipping::RC::RIGHT;
-
-    if(c.y < m_w->minY)
+    if(c.y < m_w->minY*w)
         rc |= Clipping::RC::BOTTOM;
-    else if(c.y > m_w->maxY)
+    if(c.y > m_w->maxY*w)
         rc |= Clipping::RC::TOP;
-
     return rc;
 }
 
-bool Clipping::CohenSutherlandLineClip(Coordinate& c1, Coordinate& c2){
-    if(c1 == c2) return clipPoint(c1);
+NCoordinate Clipping::nearIntersection(const NCoordinate& a, const NCoordinate& b){
+    // Os vertices na frente ja foram divididos: voltam a ser homogêneos
+    double ax = a.x, ay = a.y, bx = b.x, by = b.y;
+    if(inFront(a)){ ax *= a.z; ay *= a.z; }
+    if(inFront(b)){ bx *= b.z; by *= b.z; }
+
+    double nearW = m_w->nearW;
+    double t = (nearW - a.z)/(b.z - a.z);
+    return NCoordinate((ax + t*(bx-ax))/nearW, (ay + t*(by-ay))/nearW, nearW);
+}
+
+bool Clipping::clipNear(NCoordinate& c1, NCoordinate& c2){
+    bool in1 = inFront(c1), in2 = inFront(c2);
+    if(!in1 && !in2)
+        return false;
 
-    int rc1 = getCoordRC(c1);
-    int rc2 = getCoordRC(c2);
+    if(!in1)
+        c1 = nearIntersection(c1, c2);
+    else if(!in2)
+        c2 = nearIntersection(c1, c2);
+    return true;
+}
 
+// Sutherland-Hodgman só com o plano near
+bool Clipping::clipNear(NCoordinates& polygon){
+    bool allInFront = true;
+    for(const auto &c : polygon){
+        if(!inFront(c)){
+            allInFront = false;
+            break;
+        }
+    }
+    if(allInFront)
+        return polygon.size() != 0;
+
+    ArenaVector<NCoordinate> tmp(m_arena);
+    tmp.reserve(2*polygon.size());
+    for(unsigned i = 0; i < polygon.size(); i++){
+        const NCoordinate &c0 = polygon[i];
+        const NCoordinate &c1 = polygon[(i+1) % polygon.size()];
+        bool in0 = inFront(c0), in1 = inFront(c1);
+
+        if(in0 != in1)// in -> out ou out -> in
+            tmp.push_back(nearIntersection(c0, c1));
+        if(in1)
+            tmp.push_back(c1);
+    }
+
+    polygon.assign(tmp.begin(), tmp.end());
+    return polygon.size() != 0;
+}
+
+template<class Run>
+void Clipping::forEachNearRun(const NCoordinate* coords, unsigned size, Run run){
+    ArenaVector<NCoordinate> part(m_arena);
+    part.reserve(size+1);
+
+    for(unsigned i = 0; i < size; i++){
+        bool in = inFront(coords[i]);
+        if(i > 0 && in != inFront(coords[i-1])){
+            part.push_back(nearIntersection(coords[i-1], coords[i]));
+            if(!in){
+                run(part.data(), (unsigned) part.size());
+                part.clear();
+            }
+        }
+        if(in)
+            part.push_back(coords[i]);
+    }
+
+    if(part.size() != 0)
+        run(part.data(), (unsigned) part.size());
+}
+
+bool Clipping::clipPoint(const NCoordinate& c){
+    return c.x >= m_w->minX && c.x <= m_w->maxX &&
+                c.y >= m_w->minY && c.y <= m_w->maxY;
+}
+
+bool Clipping::clipLine(NCoordinate& c1, NCoordinate& c2){
+    // Só os casos ambiguos chegam aos algoritmos
+    int rc1 = getCoordRC(c1), rc2 = getCoordRC(c2);
+    if((rc1 | rc2) == 0)
+        return true;
+    if((rc1 & rc2) != 0)
+        return false;
+    // Dentro da guard band: o cairo corta o que passar da window
+    if((getGuardRC(c1) | getGuardRC(c2)) == 0)
+        return true;
+
+    if(m_sampling && m_lineSamples.size() < 2*CALIBRATION_SAMPLES){
+        m_lineSamples.push_back(c1);
+        m_lineSamples.push_back(c2);
+    }
+    return runLineClip(m_current == LineClipAlgs::AUTO ? m_auto : m_current,
+                       c1, c2, rc1, rc2);
+}
+
+bool Clipping::runLineClip(LineClipAlgs alg, NCoordinate& c1, NCoordinate& c2, int rc1, int rc2){
+    switch(alg){
+    case LineClipAlgs::LB:
+        return LiangBaskyLineClip(c1,c2);
+    case LineClipAlgs::NLN:
+        return NichollLeeNichollLineClip(c1,c2,rc1,rc2);
+    default:
+        return CohenSutherlandLineClip(c1,c2,rc1,rc2);
+    }
+}
+
+LineClipAlgs Clipping::calibrate(const NCoordinates& samples){
+    typedef std::chrono::steady_clock Clock;
+    const LineClipAlgs algs[] = {LineClipAlgs::CS, LineClipAlgs::LB, LineClipAlgs::NLN};
+    LineClipAlgs best = m_auto;
+    double bestTime = std::numeric_limits<double>::max();
+
+    for(LineClipAlgs alg : algs){
+        // O melhor de algumas passadas, para fugir do ruido
+        double time = std::numeric_limits<double>::max();
+        for(int rep = 0; rep < CALIBRATION_REPS; rep++){
+            Clock::time_point start = Clock::now();
+            for(unsigned i = 0; i+1 < samples.size(); i += 2){
+                NCoordinate c1 = samples[i], c2 = samples[i+1];
+                m_calibrationHits += runLineClip(alg, c1, c2, getCoordRC(c1), getCoordRC(c2));
+            }
+            time = std::min(time, std::chrono::duration<double>(Clock::now()-start).count());
+        }
+        if(time < bestTime){
+            bestTime = time;
+            best = alg;
+        }
+    }
+
+    setAutoLineClipAlg(best);
+    return best;
+}
+
+//https://en.wikipedia.org/wiki/Cohen%E2%80%93Sutherland_algorithm
+//  Sem desvios: com minX < maxX os dois lados de
+//  um eixo nunca valem ao mesmo tempo
+int Clipping::getCoordRC(const NCoordinate& c){
+    return (c.x < m_w->minX) * Clipping::RC::LEFT |
+           (c.x > m_w->maxX) * Clipping::RC::RIGHT |
+           (c.y < m_w->minY) * Clipping::RC::BOTTOM |
+           (c.y > m_w->maxY) * Clipping::RC::TOP;
+}
+
+int Clipping::getGuardRC(const NCoordinate& c){
+    return (c.x < m_w->guardMinX || c.x > m_w->guardMaxX ||
+            c.y < m_w->guardMinY || c.y > m_w->guardMaxY) * Clipping::RC::GUARD;
+}
+
+// 'rc1' e 'rc2' ja calculados em clipLine()
+bool Clipping::CohenSutherlandLineClip(NCoordinate& c1, NCoordinate& c2, int rc1, int rc2){
     while(true){
         if( (rc1 | rc2) == 0 )// Dentro
             return true;
@@ -177,8 +639,90 @@ bool Clipping::CohenSutherlandLineClip(Coordinate& c1, Coordinate& c2){
     }
 }
 
+//Nicholl, Lee e Nicholl, "An efficient new algorithm for 2-D line
+//  clipping" (1987). A região do ponto de fora diz por quais bordas a
+//  linha pode entrar, e a comparação com as retas que vão dele até os
+//  cantos escolhe a borda certa: só as interseções usadas são calculadas.
+//  Reflexões [exatas no ponto flutuante] e a troca de x com y levam
+//  o ponto de fora para a esquerda ou para o canto de baixo à esquerda
+bool Clipping::NichollLeeNichollLineClip(NCoordinate& c1, NCoordinate& c2, int rc1, int rc2){
+    // O ponto de fora fica sempre em c1
+    bool swapped = rc1 == 0;
+    if(swapped){
+        std::swap(c1, c2);
+        std::swap(rc1, rc2);
+    }
+
+    double x1 = c1.x, y1 = c1.y, x2 = c2.x, y2 = c2.y;
+    double xl = m_w->minX, xr = m_w->maxX, yb = m_w->minY, yt = m_w->maxY;
+    bool flipX = rc1 & Clipping::RC::RIGHT, flipY = rc1 & Clipping::RC::TOP;
+    bool transpose = !(rc1 & (Clipping::RC::LEFT | Clipping::RC::RIGHT));
+    if(flipX){
+        x1 = -x1; x2 = -x2;
+        xl = -m_w->maxX; xr = -m_w->minX;
+    }
+    if(flipY){
+        y1 = -y1; y2 = -y2;
+        yb = -m_w->maxY; yt = -m_w->minY;
+    }
+    if(transpose){// Só embaixo: vira só à esquerda
+        std::swap(x1, y1); std::swap(x2, y2);
+        std::swap(xl, yb); std::swap(xr, yt);
+    }
+
+    // Fora de um lado só [clipLine()]: c2 não esta à esquerda,
+    //  então dx > 0, e no canto também dy > 0
+    double dx = x2-x1, dy = y2-y1;
+    // > 0: c2 acima da reta de c1 até o canto (x, y)
+    auto side = [&](double x, double y){ return (x-x1)*dy - (y-y1)*dx; };
+
+    double ex, ey;// Entrada
+    if(y1 >= yb || side(xl, yb) > 0){// Pela esquerda
+        if(side(xl, yt) > 0 || side(xl, yb) < 0)
+            return false;
+        ex = xl;
+        ey = y1 + dy*(xl-x1)/dx;
+    }else{// Canto, por baixo
+        if(side(xr, yb) < 0)
+            return false;
+        ex = x1 + dx*(yb-y1)/dy;
+        ey = yb;
+    }
+
+    double sx = x2, sy = y2;// Saida
+    if(rc2 != 0){
+        if(side(xr, yt) > 0){
+            sx = x1 + dx*(yt-y1)/dy;
+            sy = yt;
+        }else if(side(xr, yb) < 0){
+            sx = x1 + dx*(yb-y1)/dy;
+            sy = yb;
+        }else{
+            sx = xr;
+            sy = y1 + dy*(xr-x1)/dx;
+        }
+    }
+
+    if(transpose){
+        std::swap(ex, ey);
+        std::swap(sx, sy);
+    }
+    if(flipX){ ex = -ex; sx = -sx; }
+    if(flipY){ ey = -ey; sy = -sy; }
+
+    c1.x = ex;
+    c1.y = ey;
+    if(rc2 != 0){
+        c2.x = sx;
+        c2.y = sy;
+    }
+    if(swapped)
+        std::swap(c1, c2);
+    return true;
+}
+
 //http://www.skytopia.com/project/articles/compsci/clipping.html
-bool Clipping::LiangBaskyLineClip(Coordinate& c1, Coordinate& c2){
+bool Clipping::LiangBaskyLineClip(NCoordinate& c1, NCoordinate& c2){
     if(c1 == c2) return clipPoint(c1);
 
     auto delta = c2 - c1;
@@ -217,9 +761,9 @@ bool Clipping::LiangBaskyLineClip(Coordinate& c1, Coordinate& c2){
     return true;
 }
 
-bool Clipping::SutherlandHodgmanPolygonClip(Object* p){
-    auto &input = p->getNCoords();
-    Coordinates tmp;
+bool Clipping::SutherlandHodgmanPolygonClip(NCoordinates& input){
+    ArenaVector<NCoordinate> tmp(m_arena);
+    tmp.reserve(2*input.size());
 
     clipLeft(input, tmp);
     clipRight(tmp, input);
@@ -229,7 +773,95 @@ bool Clipping::SutherlandHodgmanPolygonClip(Object* p){
     return (input.size() != 0);
 }
 
-void Clipping::clipLeft(Coordinates& input, Coordinates& output){
+bool Clipping::clipPolygonCoords(NCoordinates& coords){
+    unsigned size;
+    if(m_polygonAlg == PolygonClipAlgs::SHR &&
+        clipReentrant([&](unsigned i) -> const NCoordinate& { return coords[i]; },
+                      coords.size(), size)){
+        coords.assign(m_polygonOut.begin(), m_polygonOut.begin()+size);
+        return size != 0;
+    }
+    return SutherlandHodgmanPolygonClip(coords);
+}
+
+template<class Input>
+bool Clipping::clipReentrant(const Input& in, unsigned size, unsigned& outSize){
+    // Basta para poligonos convexos [no maximo um vertice a mais
+    //  por borda]; os outros, se não couberem, usam o SH normal
+    unsigned capacity = 2*size + 4;
+    if(m_polygonOut.size() < capacity)
+        m_polygonOut.resize(capacity);
+
+    outSize = ReentrantPolygonClip(in, size, m_polygonOut.data(), capacity);
+    return outSize <= capacity;
+}
+
+template<class Input>
+unsigned Clipping::ReentrantPolygonClip(const Input& in, unsigned size,
+                                        NCoordinate* out, unsigned capacity) const {
+    SHEdge edges[4];
+    SHOutput output{out, 0, capacity};
+
+    for(unsigned i = 0; i < size; i++)
+        shVertex<0>(edges, in(i), output);
+    shClose<0>(edges, output);
+
+    return output.size;
+}
+
+template<int E>
+bool Clipping::insideEdge(const NCoordinate& c) const {
+    switch(E){
+    case 0:  return c.x >= m_w->minX;
+    case 1:  return c.x <= m_w->maxX;
+    case 2:  return c.y >= m_w->minY;
+    default: return c.y <= m_w->maxY;
+    }
+}
+
+// Mesmas contas do clipLeft, clipRight... : o resultado eh o
+//  mesmo, só começando por outro vertice
+template<int E>
+NCoordinate Clipping::intersectEdge(const NCoordinate& c0, const NCoordinate& c1) const {
+    if(E < 2){
+        double x = (E == 0) ? m_w->minX : m_w->maxX;
+        double m = (c1.y-c0.y)/(c1.x-c0.x);
+        return NCoordinate(x, m * (x-c0.x) + c0.y);
+    }
+    double y = (E == 2) ? m_w->minY : m_w->maxY;
+    double m = (c1.x-c0.x)/(c1.y-c0.y);
+    return NCoordinate(m * (y-c0.y) + c0.x, y);
+}
+
+template<int E>
+void Clipping::shVertex(SHEdge* edges, const NCoordinate& c, SHOutput& out) const {
+    SHEdge &edge = edges[E];
+    bool inside = insideEdge<E>(c);
+
+    if(!edge.started){
+        edge.first = c;
+        edge.started = true;
+    }else if(insideEdge<E>(edge.prev) != inside)// in -> out ou out -> in
+        shVertex<E+1>(edges, intersectEdge<E>(edge.prev, c), out);
+
+    if(inside)
+        shVertex<E+1>(edges, c, out);
+    edge.prev = c;
+}
+
+// Aresta do ultimo vertice de volta ao primeiro. As bordas são
+//  fechadas em ordem: cada uma ainda pode mandar um vertice
+//  para as seguintes
+template<int E>
+void Clipping::shClose(SHEdge* edges, SHOutput& out) const {
+    SHEdge &edge = edges[E];
+    if(edge.started && insideEdge<E>(edge.prev) != insideEdge<E>(edge.first))
+        shVertex<E+1>(edges, intersectEdge<E>(edge.prev, edge.first), out);
+    shClose<E+1>(edges, out);
+}
+
+template<class Input, class Output>
+void Clipping::clipLeft(Input& input, Output& output){
     if(output.size() > 0)
         output.clear();
     if(input.size() == 0)
@@ -238,8 +870,8 @@ void Clipping::clipLeft(Coordinates& input, Coordinates& output){
     double clipX = m_w->minX;
     input.push_back(input[0]);
     for(unsigned int i = 0; i < input.size()-1; i++){
-        Coordinate c0 = input[i];
-        Coordinate c1 = input[i+1];
+        NCoordinate c0 = input[i];
+        NCoordinate c1 = input[i+1];
 
         //Caso 1: out -> out
         if(c0.x < clipX && c1.x < clipX){
@@ -270,7 +902,8 @@ void Clipping::clipLeft(Coordinates& input, Coordinates& output){
     }
 }
 
-void Clipping::clipRight(Coordinates& input, Coordinates& output){
+template<class Input, class Output>
+void Clipping::clipRight(Input& input, Output& output){
     if(output.size() > 0)
         output.clear();
     if(input.size() == 0)
@@ -279,8 +912,8 @@ void Clipping::clipRight(Coordinates& input, Coordinates& output){
     double clipX = m_w->maxX;
     input.push_back(input[0]);
     for(unsigned int i = 0; i < input.size()-1; i++){
-        Coordinate c0 = input[i];
-        Coordinate c1 = input[i+1];
+        NCoordinate c0 = input[i];
+        NCoordinate c1 = input[i+1];
 
         //Caso 1: out -> out
         if(c0.x > clipX && c1.x > clipX){
@@ -311,7 +944,8 @@ void Clipping::clipRight(Coordinates& input, Coordinates& output){
     }
 }
 
-void Clipping::clipTop(Coordinates& input, Coordinates& output){
+template<class Input, class Output>
+void Clipping::clipTop(Input& input, Output& output){
     if(output.size() > 0)
         output.clear();
     if(input.size() == 0)
@@ -320,8 +954,8 @@ void Clipping::clipTop(Coordinates& input, Coordinates& output){
     double clipY = m_w->maxY;
     input.push_back(input[0]);
     for(unsigned int i = 0; i < input.size()-1; i++){
-        Coordinate c0 = input[i];
-        Coordinate c1 = input[i+1];
+        NCoordinate c0 = input[i];
+        NCoordinate c1 = input[i+1];
 
         //Caso 1: out -> out
         if(c0.y > clipY && c1.y > clipY){
@@ -352,7 +986,8 @@ void Clipping::clipTop(Coordinates& input, Coordinates& output){
     }
 }
 
-void Clipping::clipBottom(Coordinates& input, Coordinates& output){
+template<class Input, class Output>
+void Clipping::clipBottom(Input& input, Output& output){
     if(output.size() > 0)
         output.clear();
     if(input.size() == 0)
@@ -361,8 +996,8 @@ void Clipping::clipBottom(Coordinates& input, Coordinates& output){
     double clipY = m_w->minY;
     input.push_back(input[0]);
     for(unsigned int i = 0; i < input.size()-1; i++){
-        Coordinate c0 = input[i];
-        Coordinate c1 = input[i+1];
+        NCoordinate c0 = input[i];
+        NCoordinate c1 = input[i+1];
 
         //Caso 1: out -> out
         if(c0.y < clipY && c1.y < clipY){
@@ -393,35 +1028,159 @@ void Clipping::clipBottom(Coordinates& input, Coordinates& output){
     }
 }
 
-bool Clipping::clipCurve(Object *obj){
-    auto& coords = obj->getNCoords();
-    Coordinates newPath;
-    bool prevInside = true;
-    Coordinate prev;
+bool Clipping::clipCurve(Curve *curve){
+    auto& coords = curve->getNCoords();
+    auto& paths = curve->getClippedPaths();
+    paths.clear();
+    ArenaVector<NCoordinate> newPath(m_arena);
+    newPath.reserve(coords.size());
+
+    if(m_w->perspective){
+        // Cada parte na frente do plano near vira um trecho
+        project(coords.data(), coords.size());
+        forEachNearRun(coords.data(), coords.size(),
+            [&](const NCoordinate* part, unsigned size){ clipPath(part, size, newPath, paths); });
+    }else
+        clipPath(coords.data(), coords.size(), newPath, paths);
+
+    if(paths.size() == 0)
+        return false;
+
+    coords.assign(newPath.begin(), newPath.end());
+    return true;
+}
+
+template<class Output>
+void Clipping::clipPath(const NCoordinate* coords, unsigned size,
+                        Output& output, IsoLines& paths){
+    // Classificação de todos os pontos de uma vez: trechos dentro
+    //  da window são copiados sem passar pelo clipping de linhas
+    ArenaVector<unsigned char> rcs(size, 0, m_arena);
+    computeRCs(coords, size, rcs.data());
+
+    // Todo dentro da window [da guard band]: copiado inteiro
+    int anyRC = 0;
+    for(auto rc : rcs)
+        anyRC |= rc;
+    if((anyRC & Clipping::RC::GUARD) == 0){
+        if(size != 0){
+            paths.push_back(IsoLine{(unsigned) output.size(), size});
+            output.insert(output.end(), coords, coords+size);
+        }
+        return;
+    }
 
-    for(unsigned int i = 0; i < coords.size(); i++){
-        if(clipPoint(coords[i])){
-            if(!prevInside){
-                clipLine(prev, coords[i]);
-                newPath.push_back(prev);
+    // Cada sequencia de pontos sem o GUARD vira um trecho, começando
+    //  e terminando onde os segmentos cruzam a borda. O que fica fora
+    //  não liga a saida com a volta [o proximo trecho começa de novo]
+    for(unsigned i = 0; i < size; ){
+        if((rcs[i] & Clipping::RC::GUARD) == 0){
+            unsigned first = output.size();
+            if(i > 0){
+                NCoordinate c1 = coords[i-1], c2 = coords[i];
+                if(clipLine(c1, c2))
+                    output.push_back(c1);
             }
-            newPath.push_back(coords[i]);
-            prevInside = true;
-        }else{
-            if(prevInside && newPath.size() != 0){
-                clipLine(prev, coords[i]);
-                newPath.push_back(coords[i]);
+
+            unsigned end = i+1;
+            while(end < size && (rcs[end] & Clipping::RC::GUARD) == 0)
+                end++;
+            output.insert(output.end(), coords+i, coords+end);
+
+            if(end < size){
+                NCoordinate c1 = coords[end-1], c2 = coords[end];
+                if(clipLine(c1, c2))
+                    output.push_back(c2);
             }
-            prevInside = false;
+            paths.push_back(IsoLine{first, (unsigned) output.size()-first});
+            i = end;
+            continue;
         }
-        prev = coords[i];
+
+        // Os dois pontos fora, mas não do mesmo lado: o
+        //  segmento ainda pode passar pela window
+        if(i+1 < size && (rcs[i+1] & Clipping::RC::GUARD) != 0 &&
+           (rcs[i] & rcs[i+1] & ~Clipping::RC::GUARD) == 0){
+            NCoordinate c1 = coords[i], c2 = coords[i+1];
+            if(clipLine(c1, c2)){
+                paths.push_back(IsoLine{(unsigned) output.size(), 2});
+                output.push_back(c1);
+                output.push_back(c2);
+            }
+        }
+        i++;
     }
+}
 
-    if(newPath.size() == 0)
-        return false;
+bool Clipping::clip(Object3D *obj){
+    prepare(obj, 0, obj->getNCoords().size());
+    // Todo dentro da window: todas as faces usam os indices
+    if(obj->isInsideWindow())
+        return obj->getFacesSize() != 0;
 
-    obj->setNCoord(newPath);
-    return true;
+    auto &clippedCoords = obj->getClippedCoords();
+    auto &clippedFaces = obj->getClippedFaces();
+    clippedCoords.clear();
+    clippedFaces.clear();
+
+    clip(obj, 0, obj->getFacesSize(), clippedCoords, clippedFaces);
+    return clippedFaces.size() != 0;
+}
+
+void Clipping::clip(Object3D *obj, unsigned first, unsigned last,
+                    NCoordinates& clippedCoords, ClippedFaces& clippedFaces){
+    const auto &nCoords = obj->getNCoords();
+    const auto &rcs = obj->getRegionCodes();
+    const auto &indices = obj->getIndices();
+    const auto &faces = obj->getFaces();
+
+    for(unsigned f = first; f < last; f++){
+        const Face &face = faces[f];
+
+        // Fora se todos os vertices estão do lado de fora do
+        //  mesmo plano [da window, ou do frustum na perspectiva]
+        int allRC = ~0, anyRC = 0;
+        for(unsigned i = face.first; i < face.first+face.size; i++){
+            int rc = rcs[indices[i]];
+            allRC &= rc;
+            anyRC |= rc;
+        }
+        if((allRC & ~Clipping::RC::GUARD) != 0)
+            continue;
+
+        // Faces totalmente dentro da window [da guard band]
+        //  continuam usando os indices, sem copiar os vertices
+        if((anyRC & (Clipping::RC::GUARD | Clipping::RC::NEAR)) == 0){
+            clippedFaces.push_back(ClippedFace{face.first, face.size, f, true});
+            continue;
+        }
+
+        // O SH reentrante le os vertices direto pelos indices
+        unsigned size;
+        if(m_polygonAlg == PolygonClipAlgs::SHR && !(anyRC & Clipping::RC::NEAR) &&
+            clipReentrant([&](unsigned i) -> const NCoordinate& {
+                              return nCoords[indices[face.first+i]]; },
+                          face.size, size)){
+            if(size == 0)
+                continue;
+            clippedFaces.push_back(ClippedFace{(unsigned) clippedCoords.size(), size, f, false});
+            clippedCoords.insert(clippedCoords.end(), m_polygonOut.begin(), m_polygonOut.begin()+size);
+            continue;
+        }
+
+        m_face.clear();
+        for(unsigned i = face.first; i < face.first+face.size; i++)
+            m_face.push_back(nCoords[indices[i]]);
+
+        if((anyRC & Clipping::RC::NEAR) && !clipNear(m_face))
+            continue;
+        if(!clipPolygonCoords(m_face))
+            continue;
+
+        clippedFaces.push_back(ClippedFace{(unsigned) clippedCoords.size(),
+                                           (unsigned) m_face.size(), f, false});
+        clippedCoords.insert(clippedCoords.end(), m_face.begin(), m_face.end());
+    }
 }
 
 #endif // CLIPPING_HPP
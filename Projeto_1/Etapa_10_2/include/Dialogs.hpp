@@ -235,4 +235,15 @@ class RotateDialog : public Dialog
             *m_objCenter = nullptr, *m_pntCenter = nullptr, *m_entryAngA = nullptr;
 };
 
+class GroupDialog : public Dialog
+{
+    public:
+        GroupDialog(GtkBuilder* builder);
+        std::string const getName() const
+            { return gtk_entry_get_text(GTK_ENTRY(m_entryName)); }
+
+    private:
+        GtkWidget *m_entryName = nullptr;
+};
+
 #endif // DIALOGS_HPP
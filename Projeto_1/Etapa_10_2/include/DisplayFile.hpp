@@ -1,24 +1,160 @@
 #ifndef DISPLAYFILE_HPP
 #define DISPLAYFILE_HPP
 
-#include "ListaEnc.hpp"
+#include <vector>
+#include <string>
+#include <unordered_map>
 #include "Objects.hpp"
 #include "MyException.hpp"
 
-class DisplayFile : public ListaEnc<Object*>
+/**
+ * Handle para um objeto do DisplayFile.
+ *  Continua valido mesmo que outros objetos
+ *  sejam removidos. Quando o proprio objeto eh
+ *  removido, a 'generation' do slot muda e o
+ *  handle antigo passa a ser invalido.
+ **/
+struct ObjHandle
+{
+    ObjHandle() {}
+    ObjHandle(unsigned i, unsigned g) :
+        index(i), generation(g) {}
+
+    unsigned index = ~0u;
+    unsigned generation = 0;
+
+    bool operator==(const ObjHandle& h) const
+        { return index == h.index && generation == h.generation; }
+    bool operator!=(const ObjHandle& h) const { return !(*this == h); }
+};
+
+/**
+ * Slot map com os objetos do mundo.
+ *  Os objetos ficam em um vetor denso, na ordem
+ *  de inserção (ordem de desenho), e os slots
+ *  fazem a ligação handle -> posição no vetor denso.
+ *
+ *  Tambem mantem um indice nome -> slot, atualizado
+ *  junto com o slot map, para as buscas por nome.
+ *
+ *  adiciona: O(1)
+ *  acesso por posição, handle ou nome: O(1)
+ *  remoção: O(n) [precisa manter a ordem de desenho]
+ **/
+class DisplayFile
 {
     public:
         DisplayFile(){}
-        virtual ~DisplayFile() {}
+        virtual ~DisplayFile();
+
+        ObjHandle addObj(Object *obj);
+        void removeObj(ObjHandle h);
+
+        Object* getObj(int pos){ return m_objs[pos]; }
+        Object* getObj(ObjHandle h);
+        ObjHandle getHandle(int pos) const;
+        // Retorna um handle invalido caso não ache
+        ObjHandle find(const std::string& name) const;
 
-        Object* getObj(int pos){ return getFromPos(pos); }
-        Object* getObj(Object *obj){ return *posicaoMem(obj); }
-        Elemento<Object*>* getFirstElement(){ return getHead(); }
+        bool contains(ObjHandle h) const;
+        bool contains(const std::string& name) const
+            { return m_names.find(name) != m_names.end(); }
+        int size() const { return m_objs.size(); }
 
-        void addObj(Object *obj){ adiciona(obj); }
-        void removeObj(Object *obj){ delete retiraEspecifico(obj); }
-        int size() const { return getSize(); }
-        bool contains(Object *obj){ return contem(obj); }
+        const std::vector<Object*>& getObjs() const { return m_objs; }
+
+    private:
+        struct Slot
+        {
+            unsigned dense;// Posição no vetor denso
+            unsigned generation;
+            bool used;
+        };
+
+    private:
+        std::vector<Object*> m_objs;// Vetor denso
+        std::vector<unsigned> m_denseToSlot;
+        std::vector<Slot> m_slots;
+        std::vector<unsigned> m_freeSlots;
+        std::unordered_map<std::string, unsigned> m_names;// Nome -> slot
 };
 
+DisplayFile::~DisplayFile(){
+    for(auto obj : m_objs)
+        delete obj;
+}
+
+ObjHandle DisplayFile::addObj(Object *obj){
+    // Reserva o nome antes do slot, nomes repetidos sao rejeitados
+    auto name = m_names.emplace(obj->getName(), 0);
+    if(!name.second)
+        throw MyException("Ja existe um objeto com o nome '"+obj->getName()+"'.\n");
+
+    unsigned index;
+    if(m_freeSlots.size() != 0){
+        index = m_freeSlots.back();
+        m_freeSlots.pop_back();
+    }else{
+        index = m_slots.size();
+        m_slots.push_back(Slot{0, 0, false});
+    }
+
+    Slot &slot = m_slots[index];
+    slot.dense = m_objs.size();
+    slot.used = true;
+
+    m_objs.push_back(obj);
+    m_denseToSlot.push_back(index);
+    name.first->second = index;
+
+    return ObjHandle{index, slot.generation};
+}
+
+void DisplayFile::removeObj(ObjHandle h){
+    if(!contains(h))
+        throw MyException("Elemento nao encontrado na lista.\n");
+
+    Slot &slot = m_slots[h.index];
+    unsigned pos = slot.dense;
+
+    m_names.erase(m_objs[pos]->getName());
+    delete m_objs[pos];
+    m_objs.erase(m_objs.begin()+pos);
+    m_denseToSlot.erase(m_denseToSlot.begin()+pos);
+
+    // Atualiza a posição dos objetos que vinham depois
+    for(unsigned i = pos; i < m_denseToSlot.size(); i++)
+        m_slots[m_denseToSlot[i]].dense = i;
+
+    slot.used = false;
+    slot.generation++;
+    m_freeSlots.push_back(h.index);
+}
+
+Object* DisplayFile::getObj(ObjHandle h){
+    if(!contains(h))
+        throw MyException("Elemento nao encontrado na lista.\n");
+    return m_objs[m_slots[h.index].dense];
+}
+
+ObjHandle DisplayFile::getHandle(int pos) const {
+    if(pos < 0 || pos >= (int) m_objs.size())
+        throw MyException("Posicao invalida.\n");
+
+    unsigned index = m_denseToSlot[pos];
+    return ObjHandle{index, m_slots[index].generation};
+}
+
+ObjHandle DisplayFile::find(const std::string& name) const {
+    auto iter = m_names.find(name);
+    if(iter == m_names.end())
+        return ObjHandle();
+    return ObjHandle(iter->second, m_slots[iter->second].generation);
+}
+
+bool DisplayFile::contains(ObjHandle h) const {
+    return h.index < m_slots.size() && m_slots[h.index].used &&
+        m_slots[h.index].generation == h.generation;
+}
+
 #endif // DISPLAYFILE_HPP
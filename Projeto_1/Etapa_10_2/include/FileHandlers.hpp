@@ -94,8 +94,11 @@ class ObjReader : public ObjStream
         void addCurve(std::stringstream& line);
         void addSurface(std::stringstream& line, ObjType type);
         void addObj3D();
+        // Agrupa os sub-objetos com o nome atual, caso exista mais de um
+        void addGroup();
 
         void loadCoordsIndexes(std::stringstream& line, Coordinates& objCoords);
+        void loadIndexes(std::stringstream& line, std::vector<int>& indexes);
 
         // Usado para destruir os objs caso de algum erro
         void destroyObjs();
@@ -108,11 +111,15 @@ class ObjReader : public ObjStream
         ColorReader m_cReader;
         bool m_usingColorsFile = false;// Existe uma chamada 'mtllib' no .obj?
         int m_numSubObjs = 0; // Numero de objetos em seguida com o mesmo nome
+        unsigned m_firstSubObj = 0;// Posição em m_objs do primeiro deles
 
         ObjType m_freeFormType = ObjType::OBJECT;
 
-        std::string m_faceName = "";
-        FaceList m_faces;
+        // Faces do objeto 3D atual, com os indices
+        //  das coordenadas do arquivo
+        std::vector<int> m_faceIndexes;
+        Faces m_faces;
+        Palette m_palette;
 };
 
 class ObjWriter : public ObjStream
@@ -122,6 +129,7 @@ class ObjWriter : public ObjStream
         void writeObjs(World *world);
 
     private:
+        void printCoords(const Coordinates& coords, const Object* obj);
         void printObj(Object* obj);
         void printObj3D(Object3D* obj);
         void printCurve(Curve* obj);
@@ -161,9 +169,25 @@ void ObjReader::addObj3D(){
     std::string name = m_numSubObjs == 0 ? m_name :
         m_name+"_sub"+std::to_string(m_numSubObjs);
 
+    // Os vertices do arquivo usados pelas faces viram o
+    //  vetor de vertices do objeto, na ordem em que aparecem
+    std::vector<int> localIndex(m_coords.size(), -1);
+    Coordinates coords;
+    Indices indices;
+    indices.reserve(m_faceIndexes.size());
+    for(int index : m_faceIndexes){
+        if(localIndex[index] == -1){
+            localIndex[index] = coords.size();
+            coords.push_back(m_coords[index]);
+        }
+        indices.push_back(localIndex[index]);
+    }
+
     // cria um obj3D usando as 'faces' ja carregadas
-    m_objs.push_back(new Object3D(name, m_faces));
+    m_objs.push_back(new Object3D(name, coords, indices, m_faces, m_palette));
     m_faces.clear();
+    m_palette.clear();
+    m_faceIndexes.clear();
 }
 
 void ObjReader::loadObjs(){
@@ -204,6 +228,7 @@ void ObjReader::loadObjs(){
     //  objeto 3D
     if(m_faces.size() != 0)
         addObj3D();
+    addGroup();
 }
 
 void ObjReader::setName(std::stringstream& line){
@@ -213,11 +238,23 @@ void ObjReader::setName(std::stringstream& line){
     //  carregadas até agora
     if(m_faces.size() != 0)
         addObj3D();
+    addGroup();
 
     line >> m_name;
     m_numSubObjs = 0;
 }
 
+void ObjReader::addGroup(){
+    if(m_objs.size() - m_firstSubObj > 1){
+        Group *group = new Group(m_name+"_group");
+        for(unsigned i = m_firstSubObj; i < m_objs.size(); i++)
+            group->addChild(m_objs[i]);
+        // Adicionado depois dos filhos
+        m_objs.push_back(group);
+    }
+    m_firstSubObj = m_objs.size();
+}
+
 void ObjReader::loadColorsFile(std::stringstream& line){
     std::string file;
     line >> file;
@@ -273,11 +310,11 @@ void ObjReader::addPoly(std::stringstream& line, bool filled){
 }
 
 void ObjReader::addFace(std::stringstream& line){
-    Coordinates objCoords;
-    loadCoordsIndexes(line, objCoords);
+    unsigned first = m_faceIndexes.size();
+    loadIndexes(line, m_faceIndexes);
 
-    std::string name = "face"+std::to_string(m_faces.size()+1);
-    m_faces.emplace_back(name, objCoords);
+    m_faces.push_back(Face{first, (unsigned) (m_faceIndexes.size()-first),
+                           addToPalette(m_palette, m_color)});
 }
 
 void ObjReader::addCurve(std::stringstream& line){
@@ -360,6 +397,14 @@ void ObjReader::addSurface(std::stringstream& line, ObjType type){
 }
 
 void ObjReader::loadCoordsIndexes(std::stringstream& line, Coordinates& objCoords){
+    std::vector<int> indexes;
+    loadIndexes(line, indexes);
+
+    for(int index : indexes)
+        objCoords.push_back(m_coords[index]);
+}
+
+void ObjReader::loadIndexes(std::stringstream& line, std::vector<int>& indexes){
     std::string pointString;
     int index = 0;
     int size = m_coords.size();
@@ -390,7 +435,7 @@ void ObjReader::loadCoordsIndexes(std::stringstream& line, Coordinates& objCoord
                 destroyObjs();
                 throw MyException("Indice de vertice invalido na linha: "+ line.str() + ".\n");
             }
-            objCoords.push_back(m_coords[index]);
+            indexes.push_back(index);
         }
         if(line.str().find("\\") == std::string::npos)
             break;
@@ -441,6 +486,9 @@ void ObjWriter::writeObjs(World *world){
     for(int i = 0; i<size; i++){
         obj = world->getObj(i);
         switch(obj->getType()){
+        case ObjType::GROUP:
+            // Os filhos são escritos separadamente
+            break;
         case ObjType::OBJECT3D:
             printObj3D((Object3D*) obj);
             break;
@@ -460,11 +508,20 @@ void ObjWriter::writeObjs(World *world){
     }
 }
 
+void ObjWriter::printCoords(const Coordinates& coords, const Object* obj){
+    // As matrizes acumuladas são aplicadas apenas na escrita,
+    //  sem alterar os objetos [instancias de Object3D
+    //  continuam compartilhando a malha]
+    for(auto c : coords){
+        if(obj->hasWorld())
+            c *= obj->getWorld();
+        m_objsFile << "v " << c.x << " " << c.y << " " << c.z << "\n";
+    }
+}
+
 void ObjWriter::printObj(Object* obj){
     auto &coords = obj->getCoords();
-
-    for(const auto &c : coords)
-        m_objsFile << "v " << c.x << " " << c.y << " " << c.z << "\n";
+    printCoords(coords, obj);
 
     m_objsFile << "\no " << obj->getName() << "\n";
 
@@ -487,36 +544,29 @@ void ObjWriter::printObj(Object* obj){
 }
 
 void ObjWriter::printObj3D(Object3D* obj){
+    auto &coords = obj->getMeshCoords();
+    printCoords(coords, obj);
 
-    for(auto face : obj->getFaceList()){
-        auto &coords = face.getCoords();
-        for(const auto &c : coords)
-            m_objsFile << "v " << c.x << " " << c.y << " " << c.z << "\n";
-    }
     m_objsFile << "\no " << obj->getName() << "\n";
 
-    unsigned int faceSize = 0;
-    for(auto &face : obj->getFaceList()){
-        faceSize = face.getCoords().size();
-
-        const std::string colorName = m_cWriter.getColorName(face.getColor());
+    const auto &indices = obj->getIndices();
+    for(const auto &face : obj->getFaces()){
+        const std::string colorName = m_cWriter.getColorName(obj->getFaceColor(face));
         if(colorName != "none")
             m_objsFile << "usemtl " << colorName << "\n";
 
         m_objsFile << "f";
-        for(unsigned int i = 0; i<faceSize; i++){
-            m_objsFile << " " << m_numVertex+(i+1);
+        for(unsigned int i = face.first; i < face.first+face.size; i++){
+            m_objsFile << " " << m_numVertex+(indices[i]+1);
         }
         m_objsFile << "\n";
-        m_numVertex += faceSize;
     }
+    m_numVertex += coords.size();
 }
 
 void ObjWriter::printCurve(Curve* obj){
     auto &coords = obj->getControlPoints();
-
-    for(const auto &c : coords)
-        m_objsFile << "v " << c.x << " " << c.y << " " << c.z << "\n";
+    printCoords(coords, obj);
 
     m_objsFile << "\no " << obj->getName() << "\n";
 
@@ -541,9 +591,7 @@ void ObjWriter::printCurve(Curve* obj){
 }
 
 void ObjWriter::printSurface(BezierSurface* obj){
-    for(const auto& c : obj->getControlPoints()){
-        m_objsFile << "v " << c.x << " " << c.y << " " << c.z << "\n";
-    }
+    printCoords(obj->getControlPoints(), obj);
 
     m_objsFile << "\no " << obj->getName() << "\n";
 
@@ -575,9 +623,7 @@ void ObjWriter::printSurface(BezierSurface* obj){
 }
 
 void ObjWriter::printSurface(BSplineSurface* obj){
-    for(const auto& c : obj->getControlPoints()){
-        m_objsFile << "v " << c.x << " " << c.y << " " << c.z << "\n";
-    }
+    printCoords(obj->getControlPoints(), obj);
 
     m_objsFile << "\no " << obj->getName() << "\n";
 
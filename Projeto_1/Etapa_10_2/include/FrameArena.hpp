@@ -0,0 +1,98 @@
+#ifndef FRAMEARENA_HPP
+#define FRAMEARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Alocador linear [bump] para os buffers temporarios de um
+ *  quadro. Alocar eh só avançar um ponteiro, nada eh liberado
+ *  individualmente: tudo volta de uma vez em reset().
+ *  Se um quadro não cabe no bloco, os blocos extras são somados
+ *  a ele no reset(). Depois de um quadro parecido não há mais
+ *  alocações no heap.
+ **/
+class FrameArena
+{
+    public:
+        explicit FrameArena(std::size_t capacity = 64*1024):
+            m_block(new char[capacity]), m_capacity(capacity) {}
+        // Cada arena tem o seu bloco: a copia só leva o tamanho
+        //  e a atribuição não muda nada
+        FrameArena(const FrameArena& a):
+            FrameArena(a.m_capacity) {}
+        FrameArena& operator=(const FrameArena&){ return *this; }
+        virtual ~FrameArena() {}
+
+        void* allocate(std::size_t bytes, std::size_t align);
+        void reset();
+
+        std::size_t getCapacity() const { return m_capacity; }
+        std::size_t getUsed() const { return m_used + m_extraBytes; }
+
+    private:
+        std::unique_ptr<char[]> m_block;
+        std::size_t m_capacity, m_used = 0;
+
+        // Blocos criados quando o principal encheu
+        std::vector<std::unique_ptr<char[]>> m_extra;
+        std::size_t m_extraBytes = 0;
+};
+
+void* FrameArena::allocate(std::size_t bytes, std::size_t align){
+    std::uintptr_t base = (std::uintptr_t) m_block.get();
+    std::size_t begin = ((base + m_used + align-1) & ~(std::uintptr_t)(align-1)) - base;
+    if(begin + bytes <= m_capacity){
+        m_used = begin + bytes;
+        return m_block.get() + begin;
+    }
+
+    // new[] ja devolve memoria alinhada para qualquer tipo
+    m_extra.emplace_back(new char[bytes]);
+    m_extraBytes += bytes;
+    return m_extra.back().get();
+}
+
+void FrameArena::reset(){
+    if(m_extra.size() != 0){
+        m_capacity += m_extraBytes;
+        m_block.reset(new char[m_capacity]);
+        m_extra.clear();
+        m_extraBytes = 0;
+    }
+    m_used = 0;
+}
+
+/**
+ * Alocador da STL usando uma FrameArena: 'deallocate' não
+ *  faz nada, a memoria só volta no reset() da arena.
+ **/
+template<class T>
+struct ArenaAllocator
+{
+    typedef T value_type;
+
+    ArenaAllocator(FrameArena& a): arena(&a) {}
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U>& a): arena(a.arena) {}
+
+    T* allocate(std::size_t n)
+        { return (T*) arena->allocate(n*sizeof(T), alignof(T)); }
+    void deallocate(T*, std::size_t) {}
+
+    FrameArena* arena;
+};
+
+template<class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+    { return a.arena == b.arena; }
+template<class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+    { return a.arena != b.arena; }
+
+template<class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif // FRAMEARENA_HPP
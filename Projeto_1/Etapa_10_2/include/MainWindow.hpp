@@ -25,6 +25,8 @@ class MainWindow
         // Events
         void openFile(GtkBuilder* builder);
         void saveFile(GtkBuilder* builder);
+        // Aplica as matrizes dos modelos nas coordenadas dos objetos
+        void bakeObjs();
 
         void addPoint(GtkBuilder* builder);
         void addLine(GtkBuilder* builder);
@@ -37,6 +39,10 @@ class MainWindow
         void zoom(Buttons id);
         void move(Buttons id);
         void rotateWindow(Buttons id);
+        // Alterna entre projeção paralela e perspectiva
+        void toggleProjection();
+        void toggleGuardBand();
+        void setThreads(unsigned threads);
 
         void setAxis(Axes axis);
 
@@ -44,11 +50,17 @@ class MainWindow
         void showPopUp(GdkEvent *event);
         void gotoSelectedObj();
         void removeSelectedObj();
+        // Novo objeto 3D compartilhando a malha do selecionado
+        void instanceSelectedObj();
+        // Coloca o selecionado em um grupo, criando-o se preciso
+        void groupSelectedObj(GtkBuilder* builder);
+        void ungroupSelectedObj();
         void translateSelectedObj(GtkBuilder* builder);
         void scaleSelectedObj(GtkBuilder* builder);
         void rotateSelectedObj(GtkBuilder* builder);
         void showHelpDialog();
         void changeLineClipAlg(LineClipAlgs alg);
+        void changePolygonClipAlg(PolygonClipAlgs alg);
 
     private:
         // Seta o parametro 'name' e 'inter' para
@@ -141,6 +153,14 @@ MainWindow::MainWindow(GtkBuilder* builder) {
                        "ID", GINT_TO_POINTER(LineClipAlgs::CS));
     g_object_set_data(G_OBJECT(gtk_builder_get_object(GTK_BUILDER(builder), "rb_LB_alg")),
                        "ID", GINT_TO_POINTER(LineClipAlgs::LB));
+    g_object_set_data(G_OBJECT(gtk_builder_get_object(GTK_BUILDER(builder), "rb_NLN_alg")),
+                       "ID", GINT_TO_POINTER(LineClipAlgs::NLN));
+    g_object_set_data(G_OBJECT(gtk_builder_get_object(GTK_BUILDER(builder), "rb_AUTO_alg")),
+                       "ID", GINT_TO_POINTER(LineClipAlgs::AUTO));
+    g_object_set_data(G_OBJECT(gtk_builder_get_object(GTK_BUILDER(builder), "rb_SH_alg")),
+                       "ID", GINT_TO_POINTER(PolygonClipAlgs::SH));
+    g_object_set_data(G_OBJECT(gtk_builder_get_object(GTK_BUILDER(builder), "rb_SHR_alg")),
+                       "ID", GINT_TO_POINTER(PolygonClipAlgs::SHR));
 
     gtk_widget_show( m_mainWindow );
 }
@@ -154,6 +174,11 @@ void MainWindow::changeLineClipAlg(LineClipAlgs alg){
     gtk_widget_queue_draw(m_mainWindow);
 }
 
+void MainWindow::changePolygonClipAlg(PolygonClipAlgs alg){
+    m_viewport->changePolygonClipAlg(alg);
+    gtk_widget_queue_draw(m_mainWindow);
+}
+
 void MainWindow::openFile(GtkBuilder* builder){
     FileDialog dialog(GTK_BUILDER(builder));
 
@@ -169,13 +194,16 @@ void MainWindow::openFile(GtkBuilder* builder){
             ObjReader r(file);
             for(auto obj : r.getObjs()){
                 try{
-                    m_world->addObj(obj);
+                    // Objetos 3D ja carregados sao reaproveitados como instancias
+                    obj = m_world->addObjOrInstance(obj);
                     m_viewport->transformAndClipObj(obj);
                     addObjOnListStore(obj->getName(), obj->getTypeName().c_str());
 
                     gtk_widget_queue_draw(m_mainWindow);
                 }catch(MyException& e){
                     log(e.what());
+                    if(obj->getParent() != nullptr)
+                        obj->getParent()->removeChild(obj);
                     delete obj;
                 }
             }
@@ -211,6 +239,16 @@ void MainWindow::saveFile(GtkBuilder* builder){
     }
 }
 
+void MainWindow::bakeObjs(){
+    m_world->bakeObjs();
+    // As coordenadas no mundo não mudam, apenas onde estão guardadas
+    for(auto obj : m_world->getObjs())
+        m_viewport->transformAndClipObj(obj);
+
+    gtk_widget_queue_draw(m_mainWindow);
+    log("Transformacoes aplicadas.\n");
+}
+
 void MainWindow::showErrorDialog(const char* msg){
     GtkWidget *dialog = gtk_message_dialog_new (GTK_WINDOW(m_mainWindow),
                                  GTK_DIALOG_DESTROY_WITH_PARENT,
@@ -302,6 +340,79 @@ void MainWindow::removeSelectedObj(){
     }
 }
 
+void MainWindow::instanceSelectedObj(){
+    GtkTreeIter iter;
+    std::string name;
+
+    if(!getSelectedObjName(name, &iter))
+        return;
+
+    try{
+        Object* obj = m_world->addInstance(m_world->instanceName(name), name);
+        m_viewport->transformAndClipObj(obj);
+        addObjOnListStore(obj->getName(), obj->getTypeName().c_str());
+
+        gtk_widget_queue_draw(m_mainWindow);
+        log("Instancia criada.\n");
+    }catch(MyException& e){
+        log(e.what());
+        showErrorDialog(e.what());
+    }
+}
+
+void MainWindow::groupSelectedObj(GtkBuilder* builder){
+    GroupDialog dialog(GTK_BUILDER(builder));
+    bool finish = false;
+
+    std::string name;
+    GtkTreeIter iter;
+
+    if(!getSelectedObjName(name, &iter))
+        return;
+
+    while(!finish){
+        if(dialog.run() == 1){
+            try{
+                std::string groupName = dialog.getName();
+                if(m_world->contains(groupName)){
+                    m_world->addToGroup(groupName, name);
+                }else{
+                    Object* group = m_world->addGroup(groupName, {name});
+                    addObjOnListStore(group->getName(), group->getTypeName().c_str());
+                }
+                // O objeto passa a usar a matriz do grupo
+                m_viewport->transformAndClipObj(m_world->getObj(name));
+
+                gtk_widget_queue_draw(m_mainWindow);
+                log("Objeto agrupado.\n");
+                finish = true;
+            }catch(MyException& e){
+                log(e.what());
+                showErrorDialog(e.what());
+            }
+        }else
+            finish = true;
+    }
+}
+
+void MainWindow::ungroupSelectedObj(){
+    GtkTreeIter iter;
+    std::string name;
+
+    if(!getSelectedObjName(name, &iter))
+        return;
+
+    try{
+        m_world->removeFromGroup(name);
+        m_viewport->transformAndClipObj(m_world->getObj(name));
+
+        gtk_widget_queue_draw(m_mainWindow);
+        log("Objeto removido do grupo.\n");
+    }catch(MyException& e){
+        log(e.what());
+    }
+}
+
 void MainWindow::zoom(Buttons id){
     double value = gtk_spin_button_get_value(GTK_SPIN_BUTTON(m_step));
     try{
@@ -342,6 +453,29 @@ void MainWindow::move(Buttons id){
     gtk_widget_queue_draw(m_mainWindow);
 }
 
+void MainWindow::toggleProjection(){
+    if(m_viewport->getProjection() == Projection::PERSPECTIVE){
+        m_viewport->setProjection(Projection::PARALLEL);
+        log("Projecao paralela.\n");
+    }else{
+        m_viewport->setProjection(Projection::PERSPECTIVE);
+        log("Projecao perspectiva.\n");
+    }
+    gtk_widget_queue_draw(m_mainWindow);
+}
+
+void MainWindow::toggleGuardBand(){
+    m_viewport->setGuardBand(!m_viewport->hasGuardBand());
+    log(m_viewport->hasGuardBand() ? "Guard band ligada.\n" : "Guard band desligada.\n");
+    gtk_widget_queue_draw(m_mainWindow);
+}
+
+void MainWindow::setThreads(unsigned threads){
+    m_viewport->setThreads(threads);
+    log(("Usando "+std::to_string(m_viewport->getThreads())+" thread(s).\n").c_str());
+    gtk_widget_queue_draw(m_mainWindow);
+}
+
 void MainWindow::rotateWindow(Buttons id){
     double value = gtk_spin_button_get_value(GTK_SPIN_BUTTON(m_step));
     char *tmpAxis = gtk_combo_box_text_get_active_text(GTK_COMBO_BOX_TEXT(m_axes));
@@ -5,9 +5,9 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <memory>
 #include "Transformation.hpp"
 
-class Transformation;
 
 class Coordinate
 {
@@ -15,7 +15,6 @@ class Coordinate
         Coordinate(){}
         Coordinate(double cx, double cy, double cz = 0.0) :
             x(cx), y(cy), z(cz), w(1.0){}
-        virtual ~Coordinate(){};
 
         Coordinate& operator+=(double step);
         Coordinate& operator-=(double step);
@@ -23,10 +22,12 @@ class Coordinate
         Coordinate& operator-=(const Coordinate& c);
         Coordinate& operator*=(const Transformation& t);
         Coordinate operator-() const;
-        bool operator==(const Coordinate& c)
+        bool operator==(const Coordinate& c) const
             { return (this->x==c.x && this->y==c.y &&
                       this->z==c.z); }
 
+        // Sem métodos virtuais: x, y, z e w ficam contiguos,
+        //  como uma linha da matriz [usado por Transformation::apply]
         double x = 0.0, y = 0.0, z = 0.0, w = 1.0;
 };
 std::ostream& operator<<(std::ostream& os, const Coordinate& c);
@@ -34,8 +35,43 @@ Coordinate operator-(const Coordinate& c1, const Coordinate& c2);
 
 typedef std::vector<Coordinate> Coordinates;
 
+#ifndef NCOORDS_DOUBLE
+// Coordenada normalizada/de clipping: apenas x, y e z em float
+//  [12 bytes, contra 32 da Coordinate]. As contas continuam em
+//  double, so o resultado eh guardado em float. Compile com
+//  -DNCOORDS_DOUBLE para usar Coordinate também aqui
+struct NCoordinate
+{
+    NCoordinate(){}
+    NCoordinate(double cx, double cy, double cz = 0.0) :
+        x(cx), y(cy), z(cz){}
+
+    bool operator==(const NCoordinate& c) const
+        { return (this->x==c.x && this->y==c.y &&
+                  this->z==c.z); }
+
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+inline NCoordinate operator-(const NCoordinate& c1, const NCoordinate& c2)
+    { return NCoordinate(c1.x-c2.x, c1.y-c2.y, c1.z-c2.z); }
+#endif
+typedef std::vector<NCoordinate> NCoordinates;
+
+// Bounding box alinhada aos eixos
+struct BoundingBox
+{
+    Coordinate min, max;
+
+    bool empty() const { return min.x > max.x; }
+    void clear();
+    void add(const Coordinate& c);
+    void add(const BoundingBox& b);
+};
+
 enum class ObjType { OBJECT, POINT, LINE, POLYGON, BEZIER_CURVE,
-    BSPLINE_CURVE, OBJECT3D, BEZIER_SURFACE, BSPLINE_SURFACE};
+    BSPLINE_CURVE, OBJECT3D, BEZIER_SURFACE, BSPLINE_SURFACE, GROUP};
+
+class Group;
 
 class Object
 {
@@ -44,7 +80,7 @@ class Object
             m_name(name) {}
         Object(const std::string& name, const GdkRGBA& c) :
             m_name(name), m_color({c.red,c.green,c.blue,c.alpha}) {}
-        virtual ~Object() {}
+        virtual ~Object();
 
         const std::string& getName() const { return m_name; }
 
@@ -54,36 +90,107 @@ class Object
 		virtual std::string getTypeName() const { return "Object"; }
 
         Coordinates& getCoords() {return m_coords;}
+        const Coordinates& getCoords() const {return m_coords;}
         Coordinate& getCoord(int index) { return m_coords[index]; }
         int getCoordsSize() const { return m_coords.size(); }
 
-        Coordinates& getNCoords() {return m_nCoords;}
-		Coordinate& getNCoord(int index) { return m_nCoords[index]; }
-		void setNCoord(const Coordinates& c);
+        NCoordinates& getNCoords() {return m_nCoords;}
+		NCoordinate& getNCoord(int index) { return m_nCoords[index]; }
 		int getNCoordsSize() const { return m_nCoords.size(); }
 
-        virtual Coordinate center() const;
+        // Centro e bounding box (em coordenadas do mundo) ficam
+        //  em cache e só são recalculados depois de alguma transformação
+        Coordinate center() const;
+        const BoundingBox& bounds() const;
+        // Todos os vertices [locais] no plano z=0
+        bool isPlanar() const;
         virtual Coordinate nCenter() const;
+
+        // As transformações são apenas acumuladas na matriz
+        //  do modelo, em O(1). As coordenadas só são alteradas
+        //  quando a matriz for 'assada' nelas [bake()]
         virtual void transform(const Transformation& t);
-        virtual void transformNormalized(const Transformation& t);
+        // Com 'only2D' calcula apenas x e y, usando uma matriz
+        //  3x3 [só para objetos planos, ver isPlanar()]
+        virtual void transformNormalized(const Transformation& t, bool only2D = false);
+        // Normalização em partes, para dividir objetos grandes entre
+        //  threads: prepareNormalized() dimensiona m_nCoords e devolve
+        //  o numero de vertices, normalizeRange() normaliza os vertices
+        //  [first, first+size) com a matriz completa [fullTransformation()]
+        virtual unsigned prepareNormalized();
+        virtual void normalizeRange(const Transformation& full, bool only2D,
+                                    unsigned first, unsigned size);
+        virtual void bake();
+        const Transformation& getModel() const { return m_model; }
+        bool hasModel() const { return m_hasModel; }
+
+        // Matriz do mundo = modelo * matriz do mundo do grupo pai.
+        //  Fica em cache e só eh recalculada quando o objeto
+        //  ou algum grupo acima dele for transformado
+        const Transformation& getWorld() const;
+        bool hasWorld() const { return m_hasModel || m_parent != nullptr; }
+        Group* getParent() const { return m_parent; }
+        // Matriz do mundo combinada com 't'
+        Transformation fullTransformation(const Transformation& t) const
+            { return hasWorld() ? getWorld() * t : t; }
+
+        // Marca usada pelo Viewport para saber se o objeto
+        //  passou pelo culling na ultima atualização da window
+        unsigned getVisibleStamp() const { return m_visibleStamp; }
+        void setVisibleStamp(unsigned stamp){ m_visibleStamp = stamp; }
+        // Bounding box inteira dentro da window [marcado pelo Viewport,
+        //  só nos Object3D e superficies]: o clipping eh pulado e o
+        //  desenho usa as coordenadas normalizadas direto
+        bool isInsideWindow() const { return m_insideWindow; }
+        void setInsideWindow(bool inside){ m_insideWindow = inside; }
 
         bool operator==(const Object& other)
             { return this->getName() == other.getName(); }
         Object& operator*(){ return *this; }
 
 		virtual void addCoordinate(double x, double y, double z)
-            { m_coords.emplace_back(x,y,z); }
-		void addCoordinate(const Coordinate& p) { m_coords.push_back(p); }
+            { m_coords.emplace_back(x,y,z); invalidateBounds(); }
+		void addCoordinate(const Coordinate& p) { m_coords.push_back(p); invalidateBounds(); }
 
     protected:
         void addCoordinate(const Coordinates& coords)
-            { m_coords.insert(m_coords.end(), coords.begin(), coords.end()); }
+            { m_coords.insert(m_coords.end(), coords.begin(), coords.end()); invalidateBounds(); }
+
+        void invalidateBounds(){ m_boundsDirty = true; invalidateWorldBounds(); }
+        // Marca a box do objeto e as dos grupos acima dele
+        void invalidateWorldBounds();
+        // Marca a matriz do mundo [e a dos filhos, nos grupos]
+        virtual void invalidateWorld();
+        // Volta o modelo para a identidade, depois do bake()
+        void resetModel();
+        // Atualiza o cache em coordenadas do mundo a partir
+        //  do cache local e da matriz do mundo
+        virtual void refreshBounds() const;
+        // Percorre todos os vertices do objeto e recalcula
+        //  o cache local [m_localBounds e m_localCenter]
+        virtual void updateBounds() const;
 
     protected:
         std::string m_name;
         GdkRGBA m_color{};// [inicializada como preta]
         Coordinates m_coords;
-        Coordinates m_nCoords; // Coordenadas normalizadadas
+        NCoordinates m_nCoords; // Coordenadas normalizadadas
+
+        Transformation m_model;
+        bool m_hasModel = false;
+
+        Group* m_parent = nullptr;
+        mutable Transformation m_world;
+        mutable bool m_worldDirty = true;
+
+        mutable BoundingBox m_localBounds, m_bounds;
+        mutable Coordinate m_localCenter, m_center;
+        mutable bool m_boundsDirty = true, m_worldBoundsDirty = true;
+
+        unsigned m_visibleStamp = 0;
+        bool m_insideWindow = false;
+
+        friend class Group;
 };
 
 class Point : public Object
@@ -140,6 +247,15 @@ class Polygon : public Object
         bool m_filled = false;
 };
 
+// Iso-linha de uma superficie [ou trecho visivel de uma curva]:
+//  intervalo [first, first+size) das coordenadas do objeto. Não
+//  tem nome nem cor propria, todas usam a cor do objeto.
+struct IsoLine
+{
+    unsigned first, size;
+};
+typedef std::vector<IsoLine> IsoLines;
+
 class Curve : public Object
 {
     public:
@@ -153,6 +269,12 @@ class Curve : public Object
         virtual void generateCurve(const Coordinates& cpCoords){};
         Coordinates& getControlPoints(){ return m_controlPoints; }
 
+        void bake();
+
+        // Resultado do clipping: trechos de m_nCoords [a curva
+        //  quebra onde sai da window e volta]
+        IsoLines& getClippedPaths(){ return m_clippedPaths; }
+
     protected:
         void setControlPoints(const Coordinates& coords)
                 { m_controlPoints.insert(m_controlPoints.end(), coords.begin(), coords.end()); }
@@ -162,6 +284,8 @@ class Curve : public Object
             // para serem usados na hora de salvar a curva no .obj
             Coordinates m_controlPoints;
             float m_step = 0.02; //Passo usado na criação da curva
+
+            IsoLines m_clippedPaths;
 };
 
 class BezierCurve : public Curve
@@ -196,37 +320,117 @@ class BSplineCurve : public Curve
 		void generateCurve(const Coordinates& cpCoords);
 };
 
+// Usada pelo Object3dDialog para montar as faces
 typedef std::vector<Polygon> FaceList;
 
+// Cores usadas pelas faces de uma malha
+typedef std::vector<GdkRGBA> Palette;
+// Indice da cor na paleta, adicionando-a caso ainda não exista
+unsigned addToPalette(Palette& palette, const GdkRGBA& color);
+
+// Face de um Object3D: intervalo [first, first+size)
+//  no vetor de indices do objeto. A face não tem nome
+//  e a cor eh um indice na paleta da malha.
+struct Face
+{
+    unsigned first, size;
+    unsigned color;
+};
+typedef std::vector<Face> Faces;
+
+// Face depois do clipping. Se 'indexed' for true, a face
+//  estava toda dentro da window e o intervalo se refere
+//  aos indices do objeto (vertices em m_nCoords), senão
+//  ele se refere as coordenadas geradas pelo clipping.
+struct ClippedFace
+{
+    unsigned first, size;
+    unsigned face;// Indice da face original
+    bool indexed;
+};
+typedef std::vector<ClippedFace> ClippedFaces;
+typedef std::vector<unsigned> Indices;
+
+/**
+ * Malha indexada: coords guarda cada vertice uma
+ *  unica vez e as faces apenas apontam para eles.
+ *  Assim um vertice compartilhado por varias faces
+ *  eh transformado e normalizado uma unica vez.
+ *
+ *  A malha eh imutavel e compartilhada entre todos os
+ *  Object3D criados a partir dela [instancias], que
+ *  guardam apenas nome, cor e matriz do modelo.
+ **/
+struct Mesh
+{
+    Mesh() {}
+    Mesh(const Coordinates& c, const Indices& i, const Faces& f, const Palette& p);
+    // Mesmos vertices, faces e cores [usado ao carregar
+    //  um arquivo para reaproveitar uma malha ja existente]
+    bool operator==(const Mesh& m) const;
+
+    Coordinates coords;
+    Indices indices;
+    Faces faces;
+    Palette palette;
+
+    // Calculados uma unica vez, na criação da malha
+    BoundingBox bounds;
+    Coordinate center;
+};
+typedef std::shared_ptr<const Mesh> MeshPtr;
+
 class Object3D : public Object
 {
     public:
         Object3D(const std::string& name) :
-            Object(name) {}
+            Object(name), m_mesh(std::make_shared<Mesh>()) {}
         Object3D(const std::string& name, const FaceList& faces) :
-            Object(name) { m_faceList = std::move(faces); }
+            Object(name), m_mesh(newMesh(faces)) {}
+        Object3D(const std::string& name, const Coordinates& coords,
+                 const Indices& indices, const Faces& faces, const Palette& palette) :
+            Object(name), m_mesh(std::make_shared<Mesh>(coords, indices, faces, palette)) {}
+        // Instancia de uma malha ja existente
+        Object3D(const std::string& name, const GdkRGBA& color, const MeshPtr& mesh) :
+            Object(name, color), m_mesh(mesh) {}
 
         virtual ObjType getType() const { return ObjType::OBJECT3D; }
 		virtual std::string getTypeName() const { return "3D Object"; }
 
-        void transform(const Transformation& t);
-        void transformNormalized(const Transformation& t);
-
-        Coordinate center() const;
-        Coordinate nCenter() const;
-
-        FaceList& getFaceList()
-            { return m_faceList; }
+        const MeshPtr& getMesh() const { return m_mesh; }
+        const Coordinates& getMeshCoords() const { return m_mesh->coords; }
+        const Faces& getFaces() const { return m_mesh->faces; }
+        const Indices& getIndices() const { return m_mesh->indices; }
+        const GdkRGBA& getFaceColor(const Face& face) const
+            { return m_mesh->palette[face.color]; }
+        int getFacesSize() const { return m_mesh->faces.size(); }
+
+        // Resultado do clipping
+        NCoordinates& getClippedCoords(){ return m_clippedCoords; }
+        ClippedFaces& getClippedFaces(){ return m_clippedFaces; }
+        // Codigos de região dos vertices normalizados, um por
+        //  vertice [calculados em Clipping::prepare()]
+        std::vector<unsigned char>& getRegionCodes(){ return m_regionCodes; }
+
+        void transformNormalized(const Transformation& t, bool only2D = false);
+        unsigned prepareNormalized();
+        void normalizeRange(const Transformation& full, bool only2D,
+                            unsigned first, unsigned size);
+        // Gera uma nova malha, so deste objeto, com a matriz aplicada
+        void bake();
+
+        static MeshPtr newMesh(const FaceList& faces);
 
-        void insertFaces(const FaceList& faces)
-            { m_faceList.insert(m_faceList.end(),
-                                faces.begin(), faces.end()); }
+    protected:
+        void updateBounds() const;
 
     protected:
-        FaceList m_faceList;
-};
+        MeshPtr m_mesh;
 
-typedef std::vector<Curve> CurveList;
+        NCoordinates m_clippedCoords;
+        ClippedFaces m_clippedFaces;
+        std::vector<unsigned char> m_regionCodes;
+};
 
 class Surface : public Object
 {
@@ -243,21 +447,26 @@ class Surface : public Object
         virtual void generateSurface(const Coordinates& cpCoords){};
         Coordinates& getControlPoints(){ return m_controlPoints; }
 
-        void transform(const Transformation& t);
-        void transformNormalized(const Transformation& t);
-
-        Coordinate center() const;
-        Coordinate nCenter() const;
+        void bake();
 
         int getMaxLines(){ return m_maxLines; }
         int getMaxCols(){ return m_maxCols; }
-        CurveList& getCurveList()
-            { return m_curveList; }
+        // Todas as iso-linhas ficam em m_coords [e m_nCoords]
+        const IsoLines& getIsoLines() const { return m_isoLines; }
+
+        // Resultado do clipping
+        NCoordinates& getClippedCoords(){ return m_clippedCoords; }
+        IsoLines& getClippedLines(){ return m_clippedLines; }
 
     protected:
         void setControlPoints(const Coordinates& coords)
                 { m_controlPoints.insert(m_controlPoints.end(), coords.begin(), coords.end()); }
 
+        void beginIsoLine()
+            { m_isoLines.push_back(IsoLine{(unsigned) m_coords.size(), 0}); }
+        void addIsoLineCoord(const Coordinate& c)
+            { addCoordinate(c); m_isoLines.back().size++; }
+
     protected:
             //Guarda os pontos de controle da surface
             // para serem usados na hora de salvar a surface no .obj
@@ -265,7 +474,10 @@ class Surface : public Object
             float m_step = 0.02; //Passo usado na criação da superficie
 
             int m_maxLines = 4, m_maxCols = 4;// Numero de linhas e colunas da matriz da surperficie
-            CurveList m_curveList;
+            IsoLines m_isoLines;
+
+            NCoordinates m_clippedCoords;
+            IsoLines m_clippedLines;
 };
 
 //http://www.cad.zju.edu.cn/home/zhx/GM/005/00-bcs2.pdf
@@ -336,4 +548,42 @@ class BSplineSurface : public Surface
                       double z, double Dz, double D2z, double D3z);
 };
 
+/**
+ * No do grafo de cena: agrupa objetos que se movem juntos.
+ *  A matriz do grupo se aplica a todos os filhos, então
+ *  transformar o grupo inteiro custa uma unica atualização
+ *  de matriz, independente do numero de filhos.
+ *
+ *  A bounding box do grupo eh a união das boxes dos filhos,
+ *  assim o Viewport descarta a sub-arvore com um unico teste.
+ **/
+class Group : public Object
+{
+    public:
+        Group(const std::string& name) :
+            Object(name) {}
+        // Os filhos continuam existindo, na mesma posição
+        virtual ~Group();
+
+        virtual ObjType getType() const { return ObjType::GROUP; }
+		virtual std::string getTypeName() const { return "Group"; }
+
+        const std::vector<Object*>& getChildren() const { return m_children; }
+        void addChild(Object* obj);
+        void removeChild(Object* obj);
+
+        // Grupos nao tem coordenadas normalizadas proprias,
+        //  os filhos são normalizados separadamente
+        void transformNormalized(const Transformation&, bool = false) {}
+        // Passa a matriz do grupo para os filhos antes de assa-los
+        void bake();
+
+    protected:
+        void invalidateWorld();
+        void refreshBounds() const;
+
+    protected:
+        std::vector<Object*> m_children;
+};
+
 #endif // OBJECTS_H
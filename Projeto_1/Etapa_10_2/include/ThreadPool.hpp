@@ -0,0 +1,190 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Pool de threads com roubo de tarefas [work stealing].
+ *  Cada participante [as threads do pool e a thread que chamou
+ *  parallelFor, que eh a de numero 0] tem a sua fila de
+ *  intervalos: pega do fim da propria fila e, quando ela
+ *  esvazia, rouba do inicio da fila dos outros. As filas
+ *  são vetores reaproveitados, sem alocações depois do
+ *  primeiro parallelFor.
+ **/
+class ThreadPool
+{
+    public:
+        // Função executada em [begin, end) pela thread 'worker'
+        typedef std::function<void(unsigned begin, unsigned end, unsigned worker)> Job;
+
+        explicit ThreadPool(unsigned threads = 1){ setThreads(threads); }
+        virtual ~ThreadPool(){ stop(); }
+
+        // Numero total de threads, contando a que chama parallelFor.
+        //  Com 1 tudo roda na thread que chamou
+        void setThreads(unsigned threads);
+        unsigned getThreads() const { return m_queues.size(); }
+
+        // Divide [0, n) em intervalos de até 'grain' elementos e
+        //  só retorna quando todos terminarem
+        void parallelFor(unsigned n, unsigned grain, const Job& job);
+
+    private:
+        struct Range { unsigned begin, end; };
+        // Intervalos [head, ranges.size()); vazia volta para o inicio
+        struct Queue
+        {
+            std::mutex mutex;
+            std::vector<Range> ranges;
+            unsigned head = 0;
+
+            bool empty() const { return head == ranges.size(); }
+            void clearIfEmpty(){ if(empty()){ ranges.clear(); head = 0; } }
+        };
+
+        void stop();
+        void workerLoop(unsigned worker);
+        // Executa intervalos até não sobrar nenhum em nenhuma fila
+        void runRanges(unsigned worker);
+        bool pop(unsigned worker, Range& r);
+        bool steal(unsigned worker, Range& r);
+
+    private:
+        std::vector<std::unique_ptr<Queue>> m_queues;
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        std::condition_variable m_wake, m_done;
+        unsigned m_generation = 0;// Incrementado a cada parallelFor
+        bool m_stop = false;
+
+        const Job* m_job = nullptr;
+        std::atomic<unsigned> m_pending{0};// Intervalos ainda não terminados
+};
+
+void ThreadPool::setThreads(unsigned threads){
+    if(threads == 0)
+        threads = 1;
+    if(threads == m_queues.size())
+        return;
+
+    stop();
+    m_stop = false;
+
+    m_queues.clear();
+    for(unsigned i = 0; i < threads; i++)
+        m_queues.emplace_back(new Queue());
+    for(unsigned i = 1; i < threads; i++)
+        m_threads.emplace_back(&ThreadPool::workerLoop, this, i);
+}
+
+void ThreadPool::stop(){
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for(auto &t : m_threads)
+        t.join();
+    m_threads.clear();
+}
+
+void ThreadPool::parallelFor(unsigned n, unsigned grain, const Job& job){
+    if(n == 0)
+        return;
+    if(grain == 0)
+        grain = 1;
+
+    unsigned threads = getThreads();
+    if(threads == 1 || n <= grain){
+        job(0, n, 0);
+        return;
+    }
+
+    // Intervalos distribuidos em rodizio entre as filas. Uma thread
+    //  ainda no parallelFor anterior pode pegar um intervalo assim
+    //  que ele entra na fila, então o contador vem antes
+    m_job = &job;
+    m_pending = (n + grain-1) / grain;
+    unsigned count = 0;
+    for(unsigned begin = 0; begin < n; begin += grain, count++){
+        Queue &q = *m_queues[count % threads];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.ranges.push_back(Range{begin, std::min(begin+grain, n)});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    runRanges(0);
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this]{ return m_pending == 0; });
+    m_job = nullptr;
+}
+
+void ThreadPool::workerLoop(unsigned worker){
+    unsigned seen = 0;
+    while(true){
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&]{ return m_stop || m_generation != seen; });
+            if(m_stop)
+                return;
+            seen = m_generation;
+        }
+        runRanges(worker);
+    }
+}
+
+void ThreadPool::runRanges(unsigned worker){
+    Range r;
+    while(pop(worker, r) || steal(worker, r)){
+        (*m_job)(r.begin, r.end, worker);
+
+        if(--m_pending == 0){
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done.notify_all();
+        }
+    }
+}
+
+bool ThreadPool::pop(unsigned worker, Range& r){
+    Queue &q = *m_queues[worker];
+    std::lock_guard<std::mutex> lock(q.mutex);
+    if(q.empty())
+        return false;
+
+    r = q.ranges.back();
+    q.ranges.pop_back();
+    q.clearIfEmpty();
+    return true;
+}
+
+bool ThreadPool::steal(unsigned worker, Range& r){
+    unsigned threads = getThreads();
+    for(unsigned i = 1; i < threads; i++){
+        Queue &q = *m_queues[(worker+i) % threads];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if(q.empty())
+            continue;
+
+        r = q.ranges[q.head++];
+        q.clearIfEmpty();
+        return true;
+    }
+    return false;
+}
+
+#endif // THREADPOOL_HPP
@@ -3,7 +3,8 @@
 
 #include <cmath>
 #include <array>
-#include "Objects.hpp"
+#include <cstddef>
+#include <iostream>
 
 #define PI 3.1415926535897932384626433832795
 
@@ -16,6 +17,12 @@ using Matrix = std::array<std::array<type, m>, n>;
 typedef Matrix<double, M_SIZE, M_SIZE> tMatrix4x4;
 
 class Coordinate;
+// Coordenadas normalizadas [ver Objects.hpp]
+#ifdef NCOORDS_DOUBLE
+typedef Coordinate NCoordinate;
+#else
+struct NCoordinate;
+#endif
 
 class Transformation
 {
@@ -28,6 +35,15 @@ class Transformation
         const tMatrix4x4& getM() const {return m_matrix;}
         tMatrix4x4& getM() {return m_matrix;}
 
+        // Aplica a transformação em 'n' coordenadas de uma vez
+        //  [in e out podem ser o mesmo vetor]. Usa SSE2/AVX
+        //  quando disponivel, escolhido em tempo de execução
+        void apply(const Coordinate* in, Coordinate* out, std::size_t n) const;
+#ifndef NCOORDS_DOUBLE
+        // Calcula em double e guarda x, y e z em float
+        void apply(const Coordinate* in, NCoordinate* out, std::size_t n) const;
+#endif
+
 		Transformation& operator*=(const Transformation& t2);
 		Transformation transpose();
 
@@ -46,6 +62,10 @@ class Transformation
         static Transformation newScaling(double sx, double sy, double sz);
 		static Transformation newScalingAroundObjCenter(double sx, double sy, double sz,
                                                   const Coordinate& center);
+        // Projeção perspectiva com o centro de projeção a uma distancia
+        //  'd' atras do plano z=0: w = (z+d)/d, então pontos sobre o
+        //  plano não mudam depois da divisão por w
+        static Transformation newPerspective(double d);
 
 		static double toRadians(double degrees) { return (PI/180) * degrees; }
 
@@ -56,4 +76,119 @@ class Transformation
 Transformation operator*(Transformation t1, const Transformation& t2);
 std::ostream& operator<<(std::ostream& os, const Transformation& t);
 
+/**
+ * Transformação afim [translação, escala e rotação].
+ *  A ultima coluna da matriz 4x4 eh sempre (0,0,0,1), então
+ *  guarda apenas as 3 primeiras: a composição faz 36
+ *  multiplicações ao inves de 64 e a aplicação lê direto a
+ *  matriz 3x4 [9 multiplicações por coordenada, sem o 'w'].
+ *
+ *  Translações e escalas são constexpr, então cadeias delas
+ *  com argumentos constantes são compostas em tempo de compilação.
+ *  As rotações dependem de sin/cos, que não são constexpr em C++11,
+ *  então continuam sendo calculadas em tempo de execução.
+ **/
+class AffineTransformation
+{
+    public:
+        constexpr AffineTransformation() :
+            AffineTransformation(1,0,0, 0,1,0, 0,0,1, 0,0,0) {}
+        constexpr AffineTransformation(double m00, double m01, double m02,
+                                       double m10, double m11, double m12,
+                                       double m20, double m21, double m22,
+                                       double m30, double m31, double m32) :
+            m_matrix{{m00,m01,m02}, {m10,m11,m12}, {m20,m21,m22}, {m30,m31,m32}} {}
+
+        constexpr double get(int i, int j) const { return m_matrix[i][j]; }
+
+        // Matriz 4x4 equivalente, para combinar com transformações não afins
+        Transformation toTransformation() const;
+        void apply(const Coordinate* in, Coordinate* out, std::size_t n) const;
+
+        AffineTransformation& operator*=(const AffineTransformation& t2);
+
+        static constexpr AffineTransformation newTranslation(double dx, double dy, double dz)
+            { return AffineTransformation(1,0,0, 0,1,0, 0,0,1, dx,dy,dz); }
+        static constexpr AffineTransformation newScaling(double sx, double sy, double sz)
+            { return AffineTransformation(sx,0,0, 0,sy,0, 0,0,sz, 0,0,0); }
+
+        static AffineTransformation newRx(double angleX, bool isRad=false);
+        static AffineTransformation newRy(double angleY, bool isRad=false);
+        static AffineTransformation newRz(double angleZ, bool isRad=false);
+        static AffineTransformation newRa(double angleA, const Coordinate& p);
+
+        static AffineTransformation newRotation(double angleX, double angleY, double angleZ);
+        static AffineTransformation newScalingAroundObjCenter(double sx, double sy, double sz,
+                                                              const Coordinate& center);
+
+    private:
+        double m_matrix[M_SIZE][M_SIZE-1];
+};
+
+// Mesma ordem de soma do Transformation::operator*=, então o
+//  resultado eh igual ao da matriz 4x4 [a coluna omitida soma 0]
+constexpr AffineTransformation operator*(const AffineTransformation& a,
+                                         const AffineTransformation& b){
+    #define AFFINE_LINEAR(i,j) (a.get(i,0)*b.get(0,j) + a.get(i,1)*b.get(1,j) + a.get(i,2)*b.get(2,j))
+    return AffineTransformation(
+        AFFINE_LINEAR(0,0), AFFINE_LINEAR(0,1), AFFINE_LINEAR(0,2),
+        AFFINE_LINEAR(1,0), AFFINE_LINEAR(1,1), AFFINE_LINEAR(1,2),
+        AFFINE_LINEAR(2,0), AFFINE_LINEAR(2,1), AFFINE_LINEAR(2,2),
+        AFFINE_LINEAR(3,0) + b.get(3,0), AFFINE_LINEAR(3,1) + b.get(3,1),
+        AFFINE_LINEAR(3,2) + b.get(3,2));
+    #undef AFFINE_LINEAR
+}
+
+/**
+ * Quaternion unitario representando uma rotação em torno
+ *  de um eixo que passa pela origem. A matriz eh montada
+ *  em forma fechada [sem atan nem produto de matrizes] e
+ *  compor duas rotações custa 16 multiplicações.
+ **/
+class Quaternion
+{
+    public:
+        constexpr Quaternion() : Quaternion(1,0,0,0) {}
+        constexpr Quaternion(double qw, double qx, double qy, double qz) :
+            w(qw), x(qx), y(qy), z(qz) {}
+
+        // Rotação inversa [quaternion unitario]
+        Quaternion conjugate() const { return Quaternion(w, -x, -y, -z); }
+        // Remove o erro acumulado depois de varias composições
+        Quaternion& normalize();
+
+        // Aplica *this e depois q2, como nas matrizes
+        Quaternion& operator*=(const Quaternion& q2);
+
+        AffineTransformation toAffine() const;
+        Transformation toTransformation() const { return toAffine().toTransformation(); }
+
+        // Rotação em torno do eixo com direção 'axis' [não precisa ser unitario]
+        static Quaternion newAxisAngle(double angle, const Coordinate& axis, bool isRad=false);
+        // Mesma ordem do Transformation::newRotation: x, depois y, depois z
+        static Quaternion newRotation(double angleX, double angleY, double angleZ);
+
+        double w, x, y, z;
+};
+
+Quaternion operator*(Quaternion q1, const Quaternion& q2);
+
+/**
+ * Transformação afim 2D [3x3]: apenas as colunas x e y
+ *  das linhas x, y e da translação de uma matriz 4x4.
+ *  Para objetos no plano z=0, quando o 'z' normalizado
+ *  não eh usado [window girando apenas em Z].
+ **/
+class Transformation2D
+{
+    public:
+        explicit Transformation2D(const Transformation& t);
+
+        // Calcula apenas x e y; z de 'out' fica 0
+        void apply(const Coordinate* in, NCoordinate* out, std::size_t n) const;
+
+    private:
+        double m_matrix[3][2];
+};
+
 #endif // TRANSFORMATION_HPP
@@ -7,117 +7,668 @@
 #include "Objects.hpp"
 #include "World.hpp"
 #include "Clipping.hpp"
+#include "ThreadPool.hpp"
 
 #define PI 3.1415926535897932384626433832795
+// Margem da guard band em cada lado, em fração do viewport
+#define GUARD_BAND 0.5
 
 class Viewport
 {
     public:
         Viewport(double width, double height, World *world):
             m_width(width), m_height(height), m_world(world), m_window(width,height),
-            m_border(new ClipWindow{-0.95,0.95,-0.95,0.95}), m_clipping(m_border)
-            { transformAndClipAllObjs(); }
+            m_device(AffineTransformation::newScaling(width/2, -height/2, 1) *
+                     AffineTransformation::newTranslation(width/2, height/2, 0)),
+            m_border(new ClipWindow{0.025*width, 0.975*width, 0.025*height, 0.975*height}),
+            m_clippings(1, Clipping(m_border)),
+            m_pool(1)
+            { setThreads(std::thread::hardware_concurrency()); }
         virtual ~Viewport(){ delete m_border; }
 
+        // As mudanças na window e nos objetos só são marcadas: a
+        //  normalização e o clipping acontecem no proximo desenho
+        //  [update()], uma vez só para várias mudanças seguidas
         void transformAndClipObj(Object* obj);
-        void changeLineClipAlg(const LineClipAlgs alg)
-            { m_clipping.setLineClipAlg(alg); transformAndClipAllObjs(); }
+        void changeLineClipAlg(const LineClipAlgs alg);
+        void changePolygonClipAlg(const PolygonClipAlgs alg);
+        // Com a guard band o que passa da window, mas fica dentro
+        //  de um retangulo maior, não eh cortado pelo Clipping: o
+        //  cairo esconde o resto [cairo_clip()]
+        void setGuardBand(bool enabled);
+        bool hasGuardBand() const { return m_guardBand; }
+        // Threads usadas para normalizar e fazer o clipping de
+        //  todos os objetos [0 ou 1: tudo na thread da interface]
+        void setThreads(unsigned threads);
+        unsigned getThreads() const { return m_pool.getThreads(); }
 
         void gotoObj(const std::string& objName);
-        void zoomWindow(double step){m_window.zoom(step); transformAndClipAllObjs();}
+        // O zoom muda quantas linhas cruzam a borda: o AUTO recalibra
+        void zoomWindow(double step)
+            { m_window.zoom(step); m_windowVersion++; startCalibration(); }
         void moveWindow(double x, double y, double z=0.0)
-            { m_window.move(x,y,z); transformAndClipAllObjs(); }
+            { m_window.move(x,y,z); m_windowVersion++; }
         void rotateWindow(double graus, const std::string& axis);
+        void setProjection(Projection p)
+            { m_window.setProjection(p); m_windowVersion++; }
+        Projection getProjection() const { return m_window.getProjection(); }
+        void setCopDistance(double distance)
+            { m_window.setCopDistance(distance); m_windowVersion++; }
+        // Atualiza as coordenadas normalizadas do que mudou
+        //  desde o ultimo desenho [chamado por drawObjs()]
+        void update();
         void drawObjs(cairo_t* cr);
 
     private:
-        Coordinate transformCoordinate(const Coordinate& c) const;
-        void transformCoordinates(const Coordinates& coords,
-                                    Coordinates& output) const;
+        // Tarefa do caminho paralelo: um objeto inteiro ['run'] ou,
+        //  para objetos divididos, os vertices [first, first+size)
+        //  do objeto m_splits[split]
+        struct FrameTask
+        {
+            void (Viewport::*run)(Object* obj, bool only2D, Clipping& clipping);
+            Object* obj;
+            bool only2D;
+            unsigned split, first, size;
+        };
+
+        // Objeto grande [Object3D ou Surface] dividido entre as threads
+        struct SplitObj
+        {
+            Object* obj;
+            Transformation full;// Matriz completa [mundo * normalização]
+            bool only2D;
+            unsigned firstBatch, lastBatch;// Lotes [firstBatch, lastBatch)
+        };
+
+        // Lote de faces [iso-linhas] [first, last) de um objeto dividido
+        struct ClipBatch
+        {
+            unsigned split, first, last;
+            NCoordinates coords;
+            ClippedFaces faces;
+            IsoLines lines;
+        };
+
+        // Tamanho das tarefas: objetos por intervalo do pool, vertices
+        //  por parte e faces [iso-linhas] por lote. Só objetos com
+        //  mais de CLIP_BATCH faces [iso-linhas] são divididos
+        enum { TASK_GRAIN = 16, VERTEX_BATCH = 4096, CLIP_BATCH = 256 };
+
+        // Testa se a bounding box (em coordenadas do mundo)
+        //  pode aparecer dentro da window [do frustum, na perspectiva]
+        bool isOnWindow(const BoundingBox& b);
+        // Testa se a bounding box fica toda dentro da window [na
+        //  frente do plano near, na perspectiva]. Conservador: com
+        //  uma folga para os arredondamentos dos vertices
+        bool isInsideWindow(const BoundingBox& b);
+        // Cantos da box normalizados [4 no caminho 2D, senão 8]
+        int transformBox(const BoundingBox& b, NCoordinate* out);
+        // Marca os Object3D e superficies com isInsideWindow()
+        void updateInside(Object* obj);
+        void updateObj(Object* obj);
+        void transformAndClip(Object* obj);
+        // Esconde o objeto [e os filhos, se for um grupo]
+        void hideObj(Object* obj);
+
+        // Calibração do LineClipAlgs::AUTO: as amostras do proximo
+        //  quadro, de todas as threads, escolhem o algoritmo
+        void startCalibration();
+        void finishCalibration();
 
         void transformAndClipAllObjs();
+        // Separa o objeto visivel [ou os filhos do grupo] por tipo
+        void collectObj(Object* obj);
+        // Loop de um unico tipo: chamadas resolvidas em tempo
+        //  de compilação, sem switch nem funções virtuais
+        template<class T>
+        void transformAndClip(std::vector<T*>& objs);
+
+        // Com mais de uma thread: cada objeto eh uma tarefa, e os
+        //  objetos grandes são divididos em partes dos vertices e
+        //  lotes de faces [iso-linhas]. O resultado eh o mesmo do
+        //  caminho serial, bit a bit
+        void transformAndClipParallel();
+        template<class T>
+        void addTasks(std::vector<T*>& objs);
+        template<class T>
+        void transformAndClip(Object* obj, bool only2D, Clipping& clipping);
+        void clipBatch(ClipBatch& batch, Clipping& clipping);
+        // Junta os lotes de um objeto dividido, na mesma ordem do serial
+        void mergeBatches(SplitObj& split);
 
         void drawObj(Object* obj);
         void drawPoint(Object* obj);
+        void drawPoint(const NCoordinate& c);
         void drawLine(Object* obj);
         void drawPolygon(Object* obj);
         void drawCurve(Object* obj);
         void drawObj3D(Object3D* obj);
+        void drawFace(Object3D* obj, const ClippedFace& cf);
         void drawSurface(Surface* obj);
 
         void prepareContext(const Object* obj);
+        void prepareContext(const GdkRGBA& color, double lineWidth = 1);
 
     private:
         double m_width, m_height;
         World* m_world;
         Window m_window;
+        // Mapeamento da window normalizada [-1,1] para o viewport
+        //  [y para baixo] e a matriz mundo -> dispositivo, que
+        //  combina a normalização com esse mapeamento. As coordenadas
+        //  normalizadas e o clipping ja ficam em pixels.
+        //  Na perspectiva as colunas z e w de m_t são trocadas: as
+        //  coordenadas normalizadas guardam x, y e w homogêneos
+        AffineTransformation m_device;
+        Transformation m_t;
+        bool m_perspective = false;
 
         cairo_t* m_cairo;
 
-        ClipWindow *m_border;
-        Clipping m_clipping;
+        ClipWindow *m_border;// Em coordenadas do dispositivo
+        bool m_guardBand = false;
+        // Uma por thread: o Clipping guarda vetores temporarios
+        std::vector<Clipping> m_clippings;
+
+        // Versão da window: incrementada a cada mudança. m_frame eh a
+        //  versão da ultima normalização, e os objetos visiveis nela
+        //  recebem este valor [getVisibleStamp()]
+        unsigned m_windowVersion = 1;
+        unsigned m_frame = 0;
+        // Objetos alterados desde o ultimo desenho [podem ter
+        //  sido removidos depois, por isso os handles]
+        std::vector<ObjHandle> m_pending;
+        // Window girando apenas em Z no quadro atual: objetos
+        //  planos usam o caminho 2D e o culling testa só 4 cantos
+        bool m_only2D = false;
+
+        // Objetos que passaram pelo culling no quadro atual,
+        //  em vetores separados por tipo [reaproveitados
+        //  entre os quadros]
+        std::vector<Point*> m_points;
+        std::vector<Line*> m_lines;
+        std::vector<Polygon*> m_polygons;
+        std::vector<Curve*> m_curves;
+        std::vector<Object3D*> m_objs3D;
+        std::vector<Surface*> m_surfaces;
+
+        ThreadPool m_pool;
+        std::vector<FrameTask> m_tasks;
+        std::vector<SplitObj> m_splits;
+        // Reaproveitados entre os quadros, só os 'm_numBatches'
+        //  primeiros são usados no quadro atual
+        std::vector<ClipBatch> m_batches;
+        unsigned m_numBatches = 0;
+
+        // Amostras de todas as threads [finishCalibration()]
+        NCoordinates m_lineSamples;
 };
 
 void Viewport::rotateWindow(double graus, const std::string& axis){
     if(axis=="x")
-        m_window.setAnguloX(graus);
+        m_window.rotate(graus, Coordinate(1,0,0));
     else if(axis=="y")
-        m_window.setAnguloY(graus);
+        m_window.rotate(graus, Coordinate(0,1,0));
     else if(axis=="z")
-        m_window.setAnguloZ(graus);
+        m_window.rotate(graus, Coordinate(0,0,1));
 
-    transformAndClipAllObjs();
+    m_windowVersion++;
+}
+
+void Viewport::changeLineClipAlg(const LineClipAlgs alg){
+    for(auto &clipping : m_clippings)
+        clipping.setLineClipAlg(alg);
+    m_windowVersion++;
+    startCalibration();
+}
+
+void Viewport::setGuardBand(bool enabled){
+    m_guardBand = enabled;
+    m_border->setGuardBand(enabled ? GUARD_BAND*m_width : 0,
+                           enabled ? GUARD_BAND*m_height : 0);
+    m_windowVersion++;
+}
+
+void Viewport::startCalibration(){
+    if(m_clippings[0].getLineClipAlg() != LineClipAlgs::AUTO)
+        return;
+    for(auto &clipping : m_clippings)
+        clipping.startCalibration();
+}
+
+void Viewport::finishCalibration(){
+    if(!m_clippings[0].isCalibrating())
+        return;
+
+    m_lineSamples.clear();
+    for(auto &clipping : m_clippings)
+        m_lineSamples.insert(m_lineSamples.end(), clipping.getLineSamples().begin(),
+                                                  clipping.getLineSamples().end());
+    // Nenhuma linha cruzou a borda: continua amostrando
+    if(m_lineSamples.empty())
+        return;
+
+    LineClipAlgs best = m_clippings[0].calibrate(m_lineSamples);
+    for(auto &clipping : m_clippings)
+        clipping.setAutoLineClipAlg(best);
+}
+
+void Viewport::changePolygonClipAlg(const PolygonClipAlgs alg){
+    for(auto &clipping : m_clippings)
+        clipping.setPolygonClipAlg(alg);
+    m_windowVersion++;
+}
+
+void Viewport::setThreads(unsigned threads){
+    m_pool.setThreads(threads);
+    Clipping clipping = m_clippings[0];
+    m_clippings.resize(m_pool.getThreads(), clipping);
+    m_windowVersion++;
 }
 
 void Viewport::gotoObj(const std::string& objName){
     Object *obj = m_world->getObj(objName);
     Coordinate c = obj->center();
     m_window.moveTo(c);
-    transformAndClipAllObjs();
+    m_windowVersion++;
 }
 
 void Viewport::transformAndClipObj(Object* obj){
-    auto t = m_window.getT();
-    obj->transformNormalized(t);
+    m_pending.push_back(m_world->getHandle(obj->getName()));
+}
+
+void Viewport::update(){
+    // A passada completa ja inclui os objetos alterados
+    if(m_frame != m_windowVersion){
+        m_pending.clear();
+        transformAndClipAllObjs();
+        return;
+    }
+
+    for(auto h : m_pending)
+        if(m_world->contains(h))
+            updateObj(m_world->getObj(h));
+    m_pending.clear();
+}
+
+void Viewport::updateObj(Object* obj){
+    if(!isOnWindow(obj->bounds())){
+        hideObj(obj);
+        return;
+    }
+    transformAndClip(obj);
+}
+
+void Viewport::hideObj(Object* obj){
+    obj->setVisibleStamp(0);
+    if(obj->getType() == ObjType::GROUP)
+        for(auto child : ((Group*) obj)->getChildren())
+            hideObj(child);
+}
 
-    if(!m_clipping.clip(obj))
+void Viewport::transformAndClip(Object* obj){
+    // A box do grupo inteiro ja passou no teste,
+    //  agora cada filho eh testado separadamente
+    if(obj->getType() == ObjType::GROUP){
+        for(auto child : ((Group*) obj)->getChildren())
+            updateObj(child);
+        return;
+    }
+
+    updateInside(obj);
+    obj->transformNormalized(m_t, m_only2D && obj->isPlanar());
+
+    if(!m_clippings[0].clip(obj))
         obj->getNCoords().clear();
+    obj->setVisibleStamp(m_frame);
 }
 
 void Viewport::transformAndClipAllObjs(){
     m_window.updateTransformation();
+    m_t = m_window.getT() * m_device.toTransformation();
+    m_perspective = m_window.isPerspective();
+    if(m_perspective)
+        for(auto &row : m_t.getM())
+            std::swap(row[2], row[3]);
+    m_border->setPerspective(m_perspective, NEAR_W);
+    // Na perspectiva o x e y dependem do z pelo w
+    m_only2D = !m_perspective && m_window.rotatesOnlyInZ();
+    m_frame = m_windowVersion;
+
+    m_points.clear();
+    m_lines.clear();
+    m_polygons.clear();
+    m_curves.clear();
+    m_objs3D.clear();
+    m_surfaces.clear();
+
+    // Objetos fora da window nem chegam a ser normalizados
+    m_world->getBVH().query(
+        [this](const BoundingBox& b){ return isOnWindow(b); },
+        [this](Object* obj){ collectObj(obj); });
+
+    if(m_pool.getThreads() > 1){
+        transformAndClipParallel();
+        return;
+    }
+
+    transformAndClip(m_points);
+    transformAndClip(m_lines);
+    transformAndClip(m_polygons);
+    transformAndClip(m_curves);
+    transformAndClip(m_objs3D);
+    transformAndClip(m_surfaces);
+}
 
-    auto element = m_world->getFirstObject();
-    while(element != nullptr){
-        transformAndClipObj(element->getInfo());
-        element = element->getProximo();
+void Viewport::collectObj(Object* obj){
+    updateInside(obj);
+    switch(obj->getType()){
+    case ObjType::OBJECT:
+        break;
+    case ObjType::GROUP:
+        for(auto child : ((Group*) obj)->getChildren())
+            if(isOnWindow(child->bounds()))
+                collectObj(child);
+        break;
+    case ObjType::POINT:
+        m_points.push_back((Point*) obj);
+        break;
+    case ObjType::LINE:
+        m_lines.push_back((Line*) obj);
+        break;
+    case ObjType::POLYGON:
+        m_polygons.push_back((Polygon*) obj);
+        break;
+    case ObjType::BEZIER_CURVE:
+    case ObjType::BSPLINE_CURVE:
+        m_curves.push_back((Curve*) obj);
+        break;
+    case ObjType::OBJECT3D:
+        m_objs3D.push_back((Object3D*) obj);
+        break;
+    case ObjType::BEZIER_SURFACE:
+    case ObjType::BSPLINE_SURFACE:
+        m_surfaces.push_back((Surface*) obj);
+        break;
     }
 }
 
-Coordinate Viewport::transformCoordinate(const Coordinate& c) const {
-    const Coordinate wmin = m_window.wMin();
-    const Coordinate wmax = m_window.wMax();
+template<class T>
+void Viewport::transformAndClip(std::vector<T*>& objs){
+    for(auto obj : objs)
+        transformAndClip<T>(obj, m_only2D && obj->isPlanar(), m_clippings[0]);
+}
 
-    double x = ((c.x-wmin.x)/(wmax.x-wmin.x))*m_width;
-    double y = (1-((c.y-wmin.y)/(wmax.y-wmin.y)))*m_height;
+template<class T>
+void Viewport::transformAndClip(Object* o, bool only2D, Clipping& clipping){
+    T* obj = (T*) o;
+    obj->T::transformNormalized(m_t, only2D);
+    if(!clipping.clip(obj))
+        obj->getNCoords().clear();
+    obj->setVisibleStamp(m_frame);
+}
+
+// Numero de faces [iso-linhas] usado para decidir se o objeto
+//  eh dividido. Os demais tipos nunca são
+template<class T>
+unsigned clipUnits(T* obj){ return 0; }
+unsigned clipUnits(Object3D* obj){ return obj->getFacesSize(); }
+unsigned clipUnits(Surface* obj){ return obj->getIsoLines().size(); }
+
+void Viewport::transformAndClipParallel(){
+    // As tarefas são montadas na thread da interface, que também
+    //  atualiza os caches dos objetos [bounds e matriz do mundo]:
+    //  as outras threads só leem esses caches
+    m_tasks.clear();
+    m_splits.clear();
+    m_numBatches = 0;
+    addTasks(m_points);
+    addTasks(m_lines);
+    addTasks(m_polygons);
+    addTasks(m_curves);
+    addTasks(m_objs3D);
+    addTasks(m_surfaces);
+
+    // Objetos inteiros e vertices dos objetos divididos
+    m_pool.parallelFor(m_tasks.size(), TASK_GRAIN,
+        [this](unsigned begin, unsigned end, unsigned worker){
+            for(unsigned i = begin; i < end; i++){
+                const FrameTask &task = m_tasks[i];
+                if(task.run != nullptr)
+                    (this->*task.run)(task.obj, task.only2D, m_clippings[worker]);
+                else{
+                    task.obj->normalizeRange(m_splits[task.split].full, task.only2D,
+                                             task.first, task.size);
+                    // Os lotes só fazem o clipping
+                    m_clippings[worker].prepare(task.obj, task.first, task.size);
+                }
+            }
+        });
+
+    if(m_splits.empty())
+        return;
+
+    // Todos os vertices ja normalizados: clipping dos lotes
+    m_pool.parallelFor(m_numBatches, 1,
+        [this](unsigned begin, unsigned end, unsigned worker){
+            for(unsigned i = begin; i < end; i++)
+                clipBatch(m_batches[i], m_clippings[worker]);
+        });
+
+    m_pool.parallelFor(m_splits.size(), 1,
+        [this](unsigned begin, unsigned end, unsigned worker){
+            for(unsigned i = begin; i < end; i++)
+                mergeBatches(m_splits[i]);
+        });
+}
+
+template<class T>
+void Viewport::addTasks(std::vector<T*>& objs){
+    for(auto obj : objs){
+        bool only2D = m_only2D && obj->isPlanar();
+        if(obj->hasWorld())
+            obj->getWorld();
+
+        unsigned units = clipUnits(obj);
+        if(units <= CLIP_BATCH){
+            m_tasks.push_back(FrameTask{&Viewport::transformAndClip<T>, obj, only2D, 0, 0, 0});
+            continue;
+        }
+
+        unsigned split = m_splits.size();
+        m_splits.push_back(SplitObj{obj, obj->fullTransformation(m_t), only2D,
+                                    m_numBatches, m_numBatches});
+
+        unsigned vertices = obj->prepareNormalized();
+        for(unsigned first = 0; first < vertices; first += VERTEX_BATCH)
+            m_tasks.push_back(FrameTask{nullptr, obj, only2D, split, first,
+                                        std::min<unsigned>(VERTEX_BATCH, vertices-first)});
+        // Todo dentro da window: nenhum lote de clipping
+        if(obj->isInsideWindow())
+            continue;
+
+        for(unsigned first = 0; first < units; first += CLIP_BATCH){
+            if(m_numBatches == m_batches.size())
+                m_batches.emplace_back();
+            ClipBatch &batch = m_batches[m_numBatches++];
+            batch.split = split;
+            batch.first = first;
+            batch.last = std::min<unsigned>(first+CLIP_BATCH, units);
+        }
+        m_splits.back().lastBatch = m_numBatches;
+    }
+}
+
+void Viewport::clipBatch(ClipBatch& batch, Clipping& clipping){
+    Object *obj = m_splits[batch.split].obj;
+    batch.coords.clear();
+    batch.faces.clear();
+    batch.lines.clear();
+
+    if(obj->getType() == ObjType::OBJECT3D)
+        clipping.clip((Object3D*) obj, batch.first, batch.last, batch.coords, batch.faces);
+    else
+        clipping.clip((Surface*) obj, batch.first, batch.last, batch.coords, batch.lines);
+}
+
+void Viewport::mergeBatches(SplitObj& split){
+    if(split.obj->isInsideWindow()){
+        split.obj->setVisibleStamp(m_frame);
+        return;
+    }
 
-    return Coordinate(x,y);
+    bool visible = false;
+
+    if(split.obj->getType() == ObjType::OBJECT3D){
+        Object3D *obj = (Object3D*) split.obj;
+        auto &coords = obj->getClippedCoords();
+        auto &faces = obj->getClippedFaces();
+        coords.clear();
+        faces.clear();
+
+        for(unsigned b = split.firstBatch; b < split.lastBatch; b++){
+            const ClipBatch &batch = m_batches[b];
+            unsigned offset = coords.size();
+            for(ClippedFace face : batch.faces){
+                if(!face.indexed)
+                    face.first += offset;
+                faces.push_back(face);
+            }
+            coords.insert(coords.end(), batch.coords.begin(), batch.coords.end());
+        }
+        visible = faces.size() != 0;
+    }else{
+        Surface *obj = (Surface*) split.obj;
+        auto &coords = obj->getClippedCoords();
+        auto &lines = obj->getClippedLines();
+        coords.clear();
+        lines.clear();
+
+        for(unsigned b = split.firstBatch; b < split.lastBatch; b++){
+            const ClipBatch &batch = m_batches[b];
+            unsigned offset = coords.size();
+            for(IsoLine line : batch.lines){
+                line.first += offset;
+                lines.push_back(line);
+            }
+            coords.insert(coords.end(), batch.coords.begin(), batch.coords.end());
+        }
+        visible = lines.size() != 0;
+    }
+
+    if(!visible)
+        split.obj->getNCoords().clear();
+    split.obj->setVisibleStamp(m_frame);
+}
+
+int Viewport::transformBox(const BoundingBox& b, NCoordinate* out){
+    // No caminho 2D o z não muda o x e y normalizados,
+    //  então os 4 cantos de baixo da box bastam
+    int n = m_only2D ? 4 : 8;
+    Coordinate corners[8];
+    for(int i = 0; i < n; i++)
+        corners[i] = Coordinate((i & 1) ? b.max.x : b.min.x,
+                                (i & 2) ? b.max.y : b.min.y,
+                                (i & 4) ? b.max.z : b.min.z);
+    if(m_only2D)
+        Transformation2D(m_t).apply(corners, out, n);
+    else
+        m_t.apply(corners, out, n);
+    return n;
+}
+
+bool Viewport::isOnWindow(const BoundingBox& b){
+    if(b.empty())
+        return false;
+
+    NCoordinate out[8];
+    int n = transformBox(b, out);
+
+    if(m_perspective){
+        // Coordenadas homogêneas: fora do frustum se todos os
+        //  cantos estão do lado de fora do mesmo plano. Sem a
+        //  divisão, cantos atras do centro de projeção não
+        //  aparecem espelhados
+        int allRC = ~0;
+        for(int i = 0; i < n; i++)
+            allRC &= m_clippings[0].getFrustumRC(out[i]);
+        return allRC == 0;
+    }
+
+    double minX = 0, maxX = 0, minY = 0, maxY = 0;
+    for(int i = 0; i < n; i++){
+        const NCoordinate &c = out[i];
+        if(i == 0 || c.x < minX) minX = c.x;
+        if(i == 0 || c.x > maxX) maxX = c.x;
+        if(i == 0 || c.y < minY) minY = c.y;
+        if(i == 0 || c.y > maxY) maxY = c.y;
+    }
+
+    return !(maxX < m_border->minX || minX > m_border->maxX ||
+             maxY < m_border->minY || minY > m_border->maxY);
 }
 
-void Viewport::transformCoordinates(const Coordinates& coords, Coordinates& output) const {
-    for(const auto &c : coords)
-        output.push_back(transformCoordinate(c));
+bool Viewport::isInsideWindow(const BoundingBox& b){
+    if(b.empty())
+        return false;
+
+    // Em pixels: bem maior que o erro do float nos vertices, que
+    //  não são normalizados com a mesma conta dos cantos
+    const double margin = 0.01;
+    NCoordinate out[8];
+    int n = transformBox(b, out);
+    for(int i = 0; i < n; i++){
+        double x = out[i].x, y = out[i].y;
+        if(m_perspective){
+            // Com todos os cantos na frente do plano near a box
+            //  projetada fica dentro do poligono dos cantos projetados
+            double w = out[i].z;
+            if(w < m_border->nearW + margin)
+                return false;
+            x /= w;
+            y /= w;
+        }
+        if(x < m_border->minX + margin || x > m_border->maxX - margin ||
+           y < m_border->minY + margin || y > m_border->maxY - margin)
+            return false;
+    }
+    return true;
+}
+
+void Viewport::updateInside(Object* obj){
+    switch(obj->getType()){
+    case ObjType::OBJECT3D:
+    case ObjType::BEZIER_SURFACE:
+    case ObjType::BSPLINE_SURFACE:
+        obj->setInsideWindow(isInsideWindow(obj->bounds()));
+        break;
+    default:
+        break;
+    }
 }
 
 void Viewport::drawObjs(cairo_t* cr){
+    update();
     m_cairo = cr;
 
-    auto element = m_world->getFirstObject();
-    while(element != nullptr){
-        drawObj(element->getInfo());
-        element = element->getProximo();
+    // Na guard band os objetos podem passar da window
+    if(m_guardBand){
+        cairo_save(m_cairo);
+        cairo_rectangle(m_cairo, m_border->minX, m_border->minY,
+                        m_border->maxX - m_border->minX, m_border->maxY - m_border->minY);
+        cairo_clip(m_cairo);
     }
+    for(auto obj : m_world->getObjs())
+        if(obj->getVisibleStamp() == m_frame)
+            drawObj(obj);
+    if(m_guardBand)
+        cairo_restore(m_cairo);
     drawObj(m_border);
+    finishCalibration();
+
+    // Os temporarios do quadro não são mais usados
+    for(auto &clipping : m_clippings)
+        clipping.resetArena();
 }
 
 void Viewport::drawObj(Object* obj){
@@ -129,6 +680,7 @@ void Viewport::drawObj(Object* obj){
 
     switch(obj->getType()){
     case ObjType::OBJECT:
+    case ObjType::GROUP:
         break;
     case ObjType::POINT:
         drawPoint(obj);
@@ -154,25 +706,25 @@ void Viewport::drawObj(Object* obj){
 }
 
 void Viewport::drawPoint(Object* obj){
-    Coordinate coord = transformCoordinate(obj->getNCoord(0));
     prepareContext(obj);
+    drawPoint(obj->getNCoord(0));
+}
 
+void Viewport::drawPoint(const NCoordinate& c){
     float size = (m_width/m_window.getWidth())/2;
     size = size < 0.7 ? 0.7 : (size > 2 ? 2 : size);//Limita entre 0.7 e 2
 
-    cairo_move_to(m_cairo, coord.x, coord.y);
-    cairo_arc(m_cairo, coord.x, coord.y, size, 0.0, (2*PI) );//pnt deveria ir diminuindo, nao?
+    cairo_move_to(m_cairo, c.x, c.y);
+    cairo_arc(m_cairo, c.x, c.y, size, 0.0, (2*PI) );//pnt deveria ir diminuindo, nao?
     cairo_fill(m_cairo);
 }
 
 void Viewport::drawLine(Object* obj){
-    auto coords = obj->getNCoords();
-    Coordinates nCoords;
-    if(coords[0] == coords[1]){// Usuario quer um ponto?
+    const auto &nCoords = obj->getNCoords();
+    if(nCoords[0] == nCoords[1]){// Usuario quer um ponto?
         drawPoint(obj);
         return;
     }
-    transformCoordinates(coords, nCoords);
     prepareContext(obj);
 
     cairo_move_to(m_cairo, nCoords[0].x, nCoords[0].y);
@@ -181,17 +733,15 @@ void Viewport::drawLine(Object* obj){
 }
 
 void Viewport::drawPolygon(Object* obj){
-    auto coords = obj->getNCoords();
-    Coordinates nCoords;
-    if(coords.size() == 1){// Usuario quer um ponto?
+    const auto &nCoords = obj->getNCoords();
+    if(nCoords.size() == 1){// Usuario quer um ponto?
         drawPoint(obj);
         return;
-    }else if(coords.size() == 2){// Usuario quer uma linha?
+    }else if(nCoords.size() == 2){// Usuario quer uma linha?
         drawLine(obj);
         return;
     }
 
-    transformCoordinates(coords, nCoords);
     prepareContext(obj);
 
     cairo_move_to(m_cairo, nCoords[0].x, nCoords[0].y);
@@ -209,35 +759,80 @@ void Viewport::drawPolygon(Object* obj){
 }
 
 void Viewport::drawObj3D(Object3D* obj){
-    for(auto &face : obj->getFaceList())
-        if(face.getNCoordsSize() > 0)
-            drawPolygon(&face);
+    // Todo dentro da window: as faces da malha, sem clipping
+    if(obj->isInsideWindow()){
+        const auto &faces = obj->getFaces();
+        for(unsigned f = 0; f < faces.size(); f++)
+            drawFace(obj, ClippedFace{faces[f].first, faces[f].size, f, true});
+        return;
+    }
+
+    for(const auto &cf : obj->getClippedFaces())
+        drawFace(obj, cf);
+}
+
+void Viewport::drawFace(Object3D* obj, const ClippedFace& cf){
+    const auto &nCoords = obj->getNCoords();
+    const auto &indices = obj->getIndices();
+    const auto &clippedCoords = obj->getClippedCoords();
+    auto coord = [&](unsigned i) -> const NCoordinate& {
+        return cf.indexed ? nCoords[indices[cf.first+i]] :
+                            clippedCoords[cf.first+i];
+    };
+
+    prepareContext(obj->getFaceColor(obj->getFaces()[cf.face]));
+    if(cf.size == 1 || (cf.size == 2 && coord(0) == coord(1))){// Ponto?
+        drawPoint(coord(0));
+        return;
+    }
+
+    cairo_move_to(m_cairo, coord(0).x, coord(0).y);
+    if(cf.size == 2){// Linha?
+        cairo_line_to(m_cairo, coord(1).x, coord(1).y);
+    }else{
+        for(unsigned i = 0; i < cf.size; i++)
+            cairo_line_to(m_cairo, coord(i).x, coord(i).y);
+        cairo_close_path(m_cairo);
+    }
+    cairo_stroke(m_cairo);
 }
 
 void Viewport::drawSurface(Surface* obj){
-    for(auto &curve : obj->getCurveList())
-        if(curve.getNCoordsSize() > 0)
-            drawCurve(&curve);
+    // Toda dentro da window: as iso-linhas originais, sem clipping
+    bool inside = obj->isInsideWindow();
+    const auto &coords = inside ? obj->getNCoords() : obj->getClippedCoords();
+    const auto &lines = inside ? obj->getIsoLines() : obj->getClippedLines();
+    // Todas as iso-linhas usam a cor da superficie
+    prepareContext(obj);
+    for(const auto &line : lines){
+        cairo_move_to(m_cairo, coords[line.first].x, coords[line.first].y);
+        for(unsigned i = line.first; i < line.first+line.size; i++)
+            cairo_line_to(m_cairo, coords[i].x, coords[i].y);
+        cairo_stroke(m_cairo);
+    }
 }
 
 void Viewport::drawCurve(Object* obj){
-    auto coords = obj->getNCoords();
-    Coordinates nCoords;
-
-    transformCoordinates(coords, nCoords);
+    const auto &nCoords = obj->getNCoords();
     prepareContext(obj);
 
-    cairo_move_to(m_cairo, nCoords[0].x, nCoords[0].y);
-    for(unsigned int i = 0; i<nCoords.size(); i++)
-        cairo_line_to(m_cairo, nCoords[i].x, nCoords[i].y);
+    // Um trecho para cada parte da curva dentro da window
+    for(const auto &path : ((Curve*) obj)->getClippedPaths()){
+        cairo_move_to(m_cairo, nCoords[path.first].x, nCoords[path.first].y);
+        for(unsigned i = path.first; i < path.first+path.size; i++)
+            cairo_line_to(m_cairo, nCoords[i].x, nCoords[i].y);
+    }
 
     cairo_stroke(m_cairo);
 }
 
 void Viewport::prepareContext(const Object* obj){
-    const GdkRGBA color = obj->getColor();
+    prepareContext(obj->getColor(), ((obj==m_border) ? 3 : 1) );//Pequena gambiarra...
+}
+
+void Viewport::prepareContext(const GdkRGBA& color, double lineWidth){
     cairo_set_source_rgb(m_cairo, color.red, color.green, color.blue);
-    cairo_set_line_width(m_cairo, ((obj==m_border) ? 3 : 1) );//Pequena gambiarra...
+    cairo_set_line_width(m_cairo, lineWidth);
 }
 
 #endif // VIEWPORT_HPP
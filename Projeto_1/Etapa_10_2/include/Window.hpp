@@ -8,6 +8,13 @@
 #define MIN_SIZE 0.001
 #define MAX_SIZE 5000
 
+// Distancia inicial do centro de projeção até a window
+#define COP_DISTANCE 500
+// Plano near [em w]: a 1% da distancia do centro de projeção
+#define NEAR_W 0.01
+
+enum class Projection { PARALLEL, PERSPECTIVE };
+
 class Window
 {
     public:
@@ -22,33 +29,61 @@ class Window
 
         double getWidth(){return m_width;}
         double getHeight(){return m_height;}
-        double getAnguloX(){ return m_angleX; }
-        double getAnguloY(){ return m_angleY; }
-        double getAnguloZ(){ return m_angleZ; }
+        const Quaternion& getOrientation() const { return m_orientation; }
 
-        void setAnguloX(double graus);
-        void setAnguloY(double graus);
-        void setAnguloZ(double graus);
+        // Gira a window em torno de um dos seus proprios eixos
+        void rotate(double graus, const Coordinate& axis);
 
         void zoom(double step);
         void move(double x, double y, double z=0.0);
         void moveTo(Coordinate center);
 
+        // Na perspectiva o centro de projeção fica 'distance' atras
+        //  do centro da window, na direção do seu eixo z
+        void setProjection(Projection p){ m_projection = p; }
+        Projection getProjection() const { return m_projection; }
+        bool isPerspective() const { return m_projection == Projection::PERSPECTIVE; }
+        void setCopDistance(double distance);
+        double getCopDistance() const { return m_copDistance; }
+
+        // Na perspectiva a matriz leva os pontos para coordenadas
+        //  homogêneas: falta a divisão por w
         void updateTransformation();
+        // Sem rotação em X e Y o x e y normalizados não
+        //  dependem do z [caminho 2D do Viewport]
+        bool rotatesOnlyInZ() const
+            { return m_orientation.x == 0 && m_orientation.y == 0; }
 
     private:
         Coordinate m_center;
-        double m_angleX = 0.0, m_angleY = 0.0,
-            m_angleZ = 0.0;
+        // Orientação da window [window -> mundo]. Guardada como
+        //  quaternion para que as rotações se acumulem na ordem
+        //  em que foram feitas, ao inves de somar angulos de Euler
+        Quaternion m_orientation;
         double m_width, m_height;
+        Projection m_projection = Projection::PARALLEL;
+        double m_copDistance = COP_DISTANCE;
         Transformation m_t;
 };
 
+void Window::setCopDistance(double distance){
+    if(distance <= 0)
+        throw MyException("A distancia do centro de projecao deve ser positiva.\n");
+    m_copDistance = distance;
+}
+
 void Window::updateTransformation(){
-    m_t = Transformation();
-    m_t *= Transformation::newTranslation(-m_center.x, -m_center.y, -m_center.z);
-    m_t *= Transformation::newRotation(-m_angleX, -m_angleY, -m_angleZ);
-    m_t *= Transformation::newScaling(1.0/m_width, 1.0/m_height, 2.0/(m_width + m_height));
+    AffineTransformation view =
+        AffineTransformation::newTranslation(-m_center.x, -m_center.y, -m_center.z) *
+        m_orientation.conjugate().toAffine();
+    AffineTransformation scale =
+        AffineTransformation::newScaling(1.0/m_width, 1.0/m_height, 2.0/(m_width + m_height));
+
+    if(isPerspective())
+        m_t = view.toTransformation() * Transformation::newPerspective(m_copDistance) *
+                scale.toTransformation();
+    else
+        m_t = (view * scale).toTransformation();
 }
 
 void Window::zoom(double step){
@@ -64,22 +99,14 @@ void Window::zoom(double step){
     m_height += step;
 }
 
-void Window::setAnguloX(double graus){
-    m_angleX += graus;
-    //m_center *= Transformation::newRx(graus);
-}
-void Window::setAnguloY(double graus){
-    m_angleY += graus;
-    //m_center *= Transformation::newRy(graus);
-}
-void Window::setAnguloZ(double graus){
-    m_angleZ += graus;
-    //m_center *= Transformation::newRz(graus);
+void Window::rotate(double graus, const Coordinate& axis){
+    m_orientation = Quaternion::newAxisAngle(graus, axis) * m_orientation;
+    m_orientation.normalize();
 }
 
 void Window::move(double x, double y, double z){
     Coordinate c(x,y,z);
-    c *= Transformation::newRotation(m_angleX, m_angleY, m_angleZ);
+    m_orientation.toAffine().apply(&c, &c, 1);
 
     m_center.x += c.x;
     m_center.y += c.y;
@@ -2,6 +2,7 @@
 #define WORLD_HPP
 
 #include "DisplayFile.hpp"
+#include "BVH.hpp"
 #include "Dialogs.hpp"
 
 class World
@@ -16,15 +17,35 @@ class World
         Object* addBezierCurve(const std::string& name, const GdkRGBA& color, const Coordinates& c);
         Object* addBSplineCurve(const std::string& name, const GdkRGBA& color, const Coordinates& c);
         Object* addObj3D(const std::string& name, const FaceList& faces);
+        // Novo Object3D compartilhando a malha de 'srcName'
+        Object* addInstance(const std::string& name, const std::string& srcName);
+        // Primeiro nome livre no formato '<srcName>_instN'
+        std::string instanceName(const std::string& srcName) const;
         Object* addSurface(const std::string& name, const GdkRGBA& color, ObjType type,
                            int maxLines, int maxCols, const Coordinates& c);
-        void addObj(Object *obj){ validateName(obj->getName()); m_objs.addObj(obj); }
+        void addObj(Object *obj){ validateName(obj->getName()); insert(obj); }
+        // Usado ao carregar arquivos: se ja existir um objeto 3D com o
+        //  mesmo nome e a mesma malha, 'obj' eh deletado e uma instancia
+        //  compartilhando a malha existente eh adicionada no lugar
+        Object* addObjOrInstance(Object *obj);
+        // Grupos: o grupo e seus filhos se movem juntos
+        Object* addGroup(const std::string& name, const std::vector<std::string>& children);
+        void addToGroup(const std::string& groupName, const std::string& objName);
+        void removeFromGroup(const std::string& objName);
 
         void removeObj(const std::string& name);
+        void removeObj(ObjHandle h){ m_objs.removeObj(h); m_bvhDirty = true; }
         int numObjs() const { return m_objs.size(); }
         Object* getObj(int pos){ return m_objs.getObj(pos); }
+        Object* getObj(ObjHandle h){ return m_objs.getObj(h); }
         Object* getObj(const std::string& name);
-        Elemento<Object*>* getFirstObject(){ return m_objs.getFirstElement(); }
+        ObjHandle getHandle(const std::string& name) const;
+        bool contains(ObjHandle h) const { return m_objs.contains(h); }
+        bool contains(const std::string& name) const { return m_objs.contains(name); }
+        const std::vector<Object*>& getObjs() const { return m_objs.getObjs(); }
+        // A BVH (apenas com os objetos fora de grupos) eh reconstruida
+        //  quando objetos são adicionados, removidos ou reagrupados
+        const BVH& getBVH();
 
         Object* translateObj(const std::string& objName, double dx, double dy, double dz);
         Object* scaleObj(const std::string& objName, double sx, double sy, double sz);
@@ -32,19 +53,54 @@ class World
         Object* rotateObj(const std::string& objName,
                           double angleX, double angleY, double angleZ,
                           double angleA, const Coordinate& p, rotateType type);
+        // Aplica as matrizes dos modelos nas coordenadas
+        //  [as transformações acima são apenas acumuladas]
+        void bakeObjs();
 
     private:
         DisplayFile m_objs;
+        BVH m_bvh;
+        bool m_bvhDirty = true;
 
         void validateName(const std::string& name);
+        Object* insert(Object *obj);
+        void refit(Object *obj);
 };
 
+Object* World::insert(Object *obj){
+    m_objs.addObj(obj);
+    m_bvhDirty = true;
+    return obj;
+}
+
+const BVH& World::getBVH(){
+    if(m_bvhDirty){
+        std::vector<Object*> roots;
+        for(auto obj : m_objs.getObjs())
+            if(obj->getParent() == nullptr)
+                roots.push_back(obj);
+
+        m_bvh.build(roots);
+        m_bvhDirty = false;
+    }
+    return m_bvh;
+}
+
+void World::refit(Object *obj){
+    if(m_bvhDirty)
+        return;
+
+    // Apenas a raiz do grupo esta na BVH
+    while(obj->getParent() != nullptr)
+        obj = obj->getParent();
+    m_bvh.refit(obj);
+}
+
 void World::validateName(const std::string& name){
     if(name == "")
         throw MyException("Adicione um nome para este objeto.\n");
 
-    Object tmp(name);
-    if(m_objs.contains(&tmp))
+    if(m_objs.contains(name))
         throw MyException("Ja existe um objeto com o nome '"+ name +"'.\n");
 }
 
@@ -52,16 +108,14 @@ Object* World::addPoint(const std::string& name, const GdkRGBA& color, const Coo
     validateName(name);
 
     Point *obj = new Point(name, color, p);
-    m_objs.addObj(obj);
-    return obj;
+    return insert(obj);
 }
 
 Object* World::addLine(const std::string& name, const GdkRGBA& color, const Coordinates& c){
     validateName(name);
 
     Line *obj = new Line(name, color, c);
-    m_objs.addObj(obj);
-    return obj;
+    return insert(obj);
 }
 
 Object* World::addPolygon(const std::string& name, const GdkRGBA& color,
@@ -69,16 +123,89 @@ Object* World::addPolygon(const std::string& name, const GdkRGBA& color,
     validateName(name);
 
     Polygon *obj = new Polygon(name, color, filled, c);
-    m_objs.addObj(obj);
-    return obj;
+    return insert(obj);
 }
 
 Object* World::addObj3D(const std::string& name, const FaceList& faces){
     validateName(name);
 
     Object3D *obj = new Object3D(name, faces);
-    m_objs.addObj(obj);
-    return obj;
+    return insert(obj);
+}
+
+Object* World::addInstance(const std::string& name, const std::string& srcName){
+    validateName(name);
+
+    Object *src = getObj(srcName);
+    if(src->getType() != ObjType::OBJECT3D)
+        throw MyException("Apenas objetos 3D podem ser instanciados.\n");
+
+    Object3D *obj = new Object3D(name, src->getColor(), ((Object3D*) src)->getMesh());
+    if(src->hasWorld())
+        obj->transform(src->getWorld());
+    return insert(obj);
+}
+
+std::string World::instanceName(const std::string& srcName) const{
+    for(int i = 1; ; i++){
+        std::string name = srcName+"_inst"+std::to_string(i);
+        if(!m_objs.contains(name))
+            return name;
+    }
+}
+
+Object* World::addObjOrInstance(Object *obj){
+    if(obj->getType() != ObjType::OBJECT3D || !m_objs.contains(obj->getName())){
+        addObj(obj);
+        return obj;
+    }
+
+    Object *src = getObj(obj->getName());
+    if(src->getType() != ObjType::OBJECT3D ||
+       !(*((Object3D*) src)->getMesh() == *((Object3D*) obj)->getMesh()))
+        throw MyException("Ja existe um objeto com o nome '"+ obj->getName() +"'.\n");
+
+    Object3D *inst = new Object3D(instanceName(src->getName()), obj->getColor(),
+                                  ((Object3D*) src)->getMesh());
+    // A instancia ocupa o lugar de 'obj' no grupo do arquivo
+    Group *group = obj->getParent();
+    if(group != nullptr){
+        group->removeChild(obj);
+        group->addChild(inst);
+    }
+    delete obj;
+    return insert(inst);
+}
+
+Object* World::addGroup(const std::string& name, const std::vector<std::string>& children){
+    validateName(name);
+
+    Group *group = new Group(name);
+    try{
+        for(const auto &child : children)
+            group->addChild(getObj(child));
+    }catch(MyException& e){
+        delete group;
+        throw;
+    }
+    return insert(group);
+}
+
+void World::addToGroup(const std::string& groupName, const std::string& objName){
+    Object *group = getObj(groupName);
+    if(group->getType() != ObjType::GROUP)
+        throw MyException("'"+ groupName +"' nao eh um grupo.\n");
+
+    ((Group*) group)->addChild(getObj(objName));
+    m_bvhDirty = true;
+}
+
+void World::removeFromGroup(const std::string& objName){
+    Object *obj = getObj(objName);
+    if(obj->getParent() != nullptr){
+        obj->getParent()->removeChild(obj);
+        m_bvhDirty = true;
+    }
 }
 
 Object* World::addSurface(const std::string& name, const GdkRGBA& color,
@@ -95,8 +222,7 @@ Object* World::addSurface(const std::string& name, const GdkRGBA& color,
     else if(type == ObjType::BSPLINE_SURFACE)
         obj = new BSplineSurface(name, color, maxLines, maxCols, c);
 
-    m_objs.addObj(obj);
-    return obj;
+    return insert(obj);
 }
 
 Object* World::addBezierCurve(const std::string& name, const GdkRGBA& color,
@@ -107,8 +233,7 @@ Object* World::addBezierCurve(const std::string& name, const GdkRGBA& color,
         throw MyException("Uma curva de Bezier deve ter 4, 7, 10, 13... coordenadas.");
 
     BezierCurve *obj = new BezierCurve(name, color, c);
-    m_objs.addObj(obj);
-    return obj;
+    return insert(obj);
 }
 
 Object* World::addBSplineCurve(const std::string& name, const GdkRGBA& color, const Coordinates& c){
@@ -118,54 +243,66 @@ Object* World::addBSplineCurve(const std::string& name, const GdkRGBA& color, co
         throw MyException("Uma curva B-Spline deve ter no minimo 4 coordenadas.");
 
     BSplineCurve *obj = new BSplineCurve(name, color, c);
-    m_objs.addObj(obj);
-    return obj;
+    return insert(obj);
 }
 
 void World::removeObj(const std::string& name){
-    Object tmp(name);
-    m_objs.removeObj(&tmp);
+    removeObj(m_objs.find(name));
 }
 
 Object* World::getObj(const std::string& name){
-    Object tmp(name);
-    return m_objs.getObj(&tmp);
+    return m_objs.getObj(m_objs.find(name));
+}
+
+ObjHandle World::getHandle(const std::string& name) const {
+    ObjHandle h = m_objs.find(name);
+    if(!m_objs.contains(h))
+        throw MyException("Elemento nao encontrado na lista.\n");
+    return h;
 }
 
 Object* World::translateObj(const std::string& objName, double dx, double dy, double dz){
-    Object tmp(objName);
-    Object *obj = m_objs.getObj(&tmp);
+    Object *obj = getObj(objName);
     obj->transform(Transformation::newTranslation(dx,dy,dz));
+    refit(obj);
     return obj;
 }
 
 Object* World::scaleObj(const std::string& objName, double sx, double sy, double sz){
-    Object tmp(objName);
-    Object *obj = m_objs.getObj(&tmp);
+    Object *obj = getObj(objName);
     obj->transform(Transformation::newScalingAroundObjCenter(sx,sy,sz,obj->center()));
+    refit(obj);
     return obj;
 }
 
 Object* World::rotateObj(const std::string& objName,
                         double angleX, double angleY, double angleZ,
                         double angleA, const Coordinate& p, rotateType type){
-    Object tmp(objName);
-    Object *obj = m_objs.getObj(&tmp);
-
-    if(angleA == 0){
-        obj->transform(Transformation::newRotation(angleX,angleY,angleZ));
-        return obj;
+    Object *obj = getObj(objName);
+
+    // Rotações compostas como quaternions, só a final vira matriz
+    Quaternion q = Quaternion::newRotation(angleX,angleY,angleZ);
+    if(angleA != 0){
+        switch(type){
+        case rotateType::OBJECT:
+            q *= Quaternion::newAxisAngle(angleA, obj->center());
+            break;
+        case rotateType::POINT:
+            q *= Quaternion::newAxisAngle(angleA, p);
+            break;
+        }
     }
 
-    switch(type){
-    case rotateType::OBJECT:
-        obj->transform(Transformation::newFullRotation(angleX,angleY,angleZ,angleA,obj->center()));
-        break;
-    case rotateType::POINT:
-        obj->transform(Transformation::newFullRotation(angleX,angleY,angleZ,angleA,p));
-        break;
-    }
+    obj->transform(q.toTransformation());
+    refit(obj);
     return obj;
 }
 
+void World::bakeObjs(){
+    // Os grupos assam os seus filhos
+    for(auto obj : m_objs.getObjs())
+        if(obj->getParent() == nullptr)
+            obj->bake();
+}
+
 #endif // WORLD_HPP
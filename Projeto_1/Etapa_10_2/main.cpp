@@ -1,4 +1,5 @@
 #include <iostream>
+#include <cstdlib>
 #include <gtk/gtk.h>
 #include "MainWindow.hpp"
 
@@ -27,6 +28,12 @@ extern "C"{
 
         window->changeLineClipAlg(alg);
     }
+    void change_poly_alg_event(GtkToggleButton *button, MainWindow* window){
+        int btnId = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(button), "ID"));
+        PolygonClipAlgs alg = (PolygonClipAlgs) btnId;
+
+        window->changePolygonClipAlg(alg);
+    }
     void color_choose_event(GtkColorButton *button, ObjDialog* dialog){
         dialog->onColorChangeEvent(button);
     }
@@ -36,6 +43,9 @@ extern "C"{
     void save_file_event(GtkMenuItem *menuitem, MainWindow* window){
         window->saveFile(builder);
     }
+    void bake_objs_event(GtkMenuItem *menuitem, MainWindow* window){
+        window->bakeObjs();
+    }
     void add_pnt_event(GtkMenuItem *menuitem, MainWindow* window){
         window->addPoint(builder);
     }
@@ -128,6 +138,14 @@ extern "C"{
         case GDK_KEY_Z:
             window->setAxis(Axes::Z);
             return true;
+        case GDK_KEY_p:
+        case GDK_KEY_P:
+            window->toggleProjection();
+            return true;
+        case GDK_KEY_g:
+        case GDK_KEY_G:
+            window->toggleGuardBand();
+            return true;
         default:
             return false;
         }
@@ -148,6 +166,15 @@ extern "C"{
     void remove_obj_event(GtkMenuItem *menuitem, MainWindow* window){
         window->removeSelectedObj();
     }
+    void instance_obj_event(GtkMenuItem *menuitem, MainWindow* window){
+        window->instanceSelectedObj();
+    }
+    void group_obj_event(GtkMenuItem *menuitem, MainWindow* window){
+        window->groupSelectedObj(builder);
+    }
+    void ungroup_obj_event(GtkMenuItem *menuitem, MainWindow* window){
+        window->ungroupSelectedObj();
+    }
     void translate_obj_event(GtkMenuItem *menuitem, MainWindow* window){
         window->translateSelectedObj(builder);
     }
@@ -189,6 +216,12 @@ int main(int argc, char ** argv)
     MainWindow* window = new MainWindow(GTK_BUILDER(builder));
     gtk_builder_connect_signals( GTK_BUILDER(builder), window );
 
+    // GDI_THREADS=n escolhe quantas threads normalizam e fazem
+    //  o clipping [0 ou 1: serial; padrão: uma por núcleo]
+    const char* threads = getenv("GDI_THREADS");
+    if(threads != nullptr && atoi(threads) >= 0)
+        window->setThreads(atoi(threads));
+
     /* ============== CSS ============== */
     GtkCssProvider *provider;
     GdkDisplay *display;
@@ -425,3 +425,18 @@ const Coordinates& SurfaceDialog::getCoords() const{
         throw MyException("Preencha todas as coordenadas.");
     return m_coords;
 }
+
+GroupDialog::GroupDialog(GtkBuilder* builder){
+    GError* error = nullptr;
+    // (char*) usado para tirar warnings do compilador
+    char* ids[] = {(char*)"dlog_group",nullptr};
+
+    if(!gtk_builder_add_objects_from_file (builder, UI_FILE, ids, &error)){
+        g_warning( "%s", error->message );
+        g_free( error );
+        return;
+    }
+
+    m_dialog = GTK_WIDGET( gtk_builder_get_object( builder, "dlog_group" ) );
+    m_entryName = GTK_WIDGET( gtk_builder_get_object( builder, "group_name" ) );
+}
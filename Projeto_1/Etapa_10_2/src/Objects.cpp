@@ -1,4 +1,7 @@
 #include "Objects.hpp"
+#include "MyException.hpp"
+#include <map>
+#include <algorithm>
 
 Transformation BSplineSurface::m_M({{
     {-1.0/6.0,     0.5,  -0.5, 1.0/6.0},
@@ -59,20 +62,98 @@ Coordinate& Coordinate::operator*=(const Transformation& t){
     return *this;
 }
 
+void BoundingBox::clear(){
+    min = Coordinate(1,1,1);
+    max = Coordinate(-1,-1,-1);
+}
+
+void BoundingBox::add(const Coordinate& c){
+    if(empty()){
+        min = max = c;
+        return;
+    }
+    if(c.x < min.x) min.x = c.x;
+    if(c.y < min.y) min.y = c.y;
+    if(c.z < min.z) min.z = c.z;
+    if(c.x > max.x) max.x = c.x;
+    if(c.y > max.y) max.y = c.y;
+    if(c.z > max.z) max.z = c.z;
+}
+
+void BoundingBox::add(const BoundingBox& b){
+    if(b.empty())
+        return;
+    add(b.min);
+    add(b.max);
+}
+
+Object::~Object(){
+    if(m_parent != nullptr)
+        m_parent->removeChild(this);
+}
+
 Coordinate Object::center() const{
+    refreshBounds();
+    return m_center;
+}
+
+const BoundingBox& Object::bounds() const{
+    refreshBounds();
+    return m_bounds;
+}
+
+bool Object::isPlanar() const{
+    refreshBounds();
+    return !m_localBounds.empty() &&
+        m_localBounds.min.z == 0 && m_localBounds.max.z == 0;
+}
+
+void Object::refreshBounds() const{
+    if(m_boundsDirty){
+        updateBounds();
+        m_boundsDirty = false;
+        m_worldBoundsDirty = true;
+    }
+    if(!m_worldBoundsDirty)
+        return;
+
+    m_center = m_localCenter;
+    m_bounds = m_localBounds;
+
+    // O centro acompanha qualquer transformação afim, já a
+    //  bounding box passa a ser a box dos 8 cantos transformados
+    if(hasWorld() && !m_localBounds.empty()){
+        const Transformation &world = getWorld();
+        m_center *= world;
+        Coordinate corners[8];
+        for(int i = 0; i < 8; i++)
+            corners[i] = Coordinate((i & 1) ? m_localBounds.max.x : m_localBounds.min.x,
+                                    (i & 2) ? m_localBounds.max.y : m_localBounds.min.y,
+                                    (i & 4) ? m_localBounds.max.z : m_localBounds.min.z);
+        world.apply(corners, corners, 8);
+        m_bounds.clear();
+        for(auto &c : corners)
+            m_bounds.add(c);
+    }
+    m_worldBoundsDirty = false;
+}
+
+void Object::updateBounds() const{
     Coordinate c;
     int n = m_coords.size();
+    m_localBounds.clear();
 
     for(auto &p : m_coords){
         c.x += p.x;
         c.y += p.y;
         c.z += p.z;
+        m_localBounds.add(p);
     }
 
     c.x /= n;
     c.y /= n;
     c.z /= n;
-    return c;
+    m_localCenter = c;
 }
 
 Coordinate Object::nCenter() const{
@@ -91,118 +172,197 @@ Coordinate Object::nCenter() const{
     return c;
 }
 
-Coordinate Object3D::center() const{
-    Coordinate c;
-    int n = 0;
+void Object::transform(const Transformation& t){
+    m_model *= t;
+    m_hasModel = true;
+    invalidateWorld();
+    invalidateWorldBounds();
+}
 
-    for(auto face : m_faceList){
-        for(auto p : face.getCoords()){
-            c.x += p.x;
-            c.y += p.y;
-            c.z += p.z;
-        }
-        n += face.getCoords().size();
+const Transformation& Object::getWorld() const{
+    if(m_parent == nullptr)
+        return m_model;
+
+    if(m_worldDirty){
+        m_world = m_model * m_parent->getWorld();
+        m_worldDirty = false;
     }
+    return m_world;
+}
 
-    c.x /= n;
-    c.y /= n;
-    c.z /= n;
-    return c;
+void Object::invalidateWorld(){
+    m_worldDirty = true;
+    m_worldBoundsDirty = true;
 }
 
-Coordinate Object3D::nCenter() const{
-    Coordinate c;
-    int n = 0;
+void Object::invalidateWorldBounds(){
+    for(Object* obj = this; obj != nullptr; obj = obj->m_parent)
+        obj->m_worldBoundsDirty = true;
+}
 
-    for(auto face : m_faceList){
-        for(auto p : face.getNCoords()){
-            c.x += p.x;
-            c.y += p.y;
-            c.z += p.z;
-        }
-        n += face.getNCoords().size();
-    }
+void Object::resetModel(){
+    m_model = Transformation();
+    m_hasModel = false;
+    invalidateWorld();
+    invalidateBounds();
+}
 
-    c.x /= n;
-    c.y /= n;
-    c.z /= n;
-    return c;
+void Object::transformNormalized(const Transformation& t, bool only2D){
+    unsigned size = Object::prepareNormalized();
+    Object::normalizeRange(fullTransformation(t), only2D, 0, size);
 }
 
-Coordinate Surface::center() const{
-    Coordinate c;
-    int n = 0;
+unsigned Object::prepareNormalized(){
+    m_nCoords.resize(m_coords.size());
+    return m_coords.size();
+}
 
-    for(auto curve : m_curveList){
-        for(auto p : curve.getCoords()){
-            c.x += p.x;
-            c.y += p.y;
-            c.z += p.z;
-        }
-        n += curve.getCoords().size();
-    }
+void Object::normalizeRange(const Transformation& full, bool only2D,
+                            unsigned first, unsigned size){
+    if(only2D)
+        Transformation2D(full).apply(m_coords.data()+first, m_nCoords.data()+first, size);
+    else
+        full.apply(m_coords.data()+first, m_nCoords.data()+first, size);
+}
 
-    c.x /= n;
-    c.y /= n;
-    c.z /= n;
-    return c;
+void Object::bake(){
+    if(!m_hasModel)
+        return;
+
+    m_model.apply(m_coords.data(), m_coords.data(), m_coords.size());
+
+    resetModel();
 }
 
-Coordinate Surface::nCenter() const{
-    Coordinate c;
-    int n = 0;
+void Curve::bake(){
+    if(!m_hasModel)
+        return;
 
-    for(auto curve : m_curveList){
-        for(auto p : curve.getNCoords()){
-            c.x += p.x;
-            c.y += p.y;
-            c.z += p.z;
-        }
-        n += curve.getNCoords().size();
-    }
+    m_model.apply(m_controlPoints.data(), m_controlPoints.data(), m_controlPoints.size());
+    Object::bake();
+}
 
-    c.x /= n;
-    c.y /= n;
-    c.z /= n;
-    return c;
+void Surface::bake(){
+    if(!m_hasModel)
+        return;
+
+    m_model.apply(m_controlPoints.data(), m_controlPoints.data(), m_controlPoints.size());
+    Object::bake();
 }
 
-void Object::transform(const Transformation& t){
-    for(auto &p : m_coords)
-        p *= (t);
+bool Mesh::operator==(const Mesh& m) const{
+    if(coords != m.coords || indices != m.indices ||
+       faces.size() != m.faces.size() || palette.size() != m.palette.size())
+        return false;
+
+    for(unsigned i = 0; i < faces.size(); i++)
+        if(faces[i].first != m.faces[i].first || faces[i].size != m.faces[i].size ||
+           faces[i].color != m.faces[i].color)
+            return false;
+
+    for(unsigned i = 0; i < palette.size(); i++)
+        if(palette[i].red != m.palette[i].red || palette[i].green != m.palette[i].green ||
+           palette[i].blue != m.palette[i].blue || palette[i].alpha != m.palette[i].alpha)
+            return false;
+
+    return true;
 }
 
-void Object::transformNormalized(const Transformation& t){
-    m_nCoords.clear();
-    for(auto p : m_coords)
-        m_nCoords.push_back( (p *= t) );
+unsigned addToPalette(Palette& palette, const GdkRGBA& color){
+    for(unsigned i = 0; i < palette.size(); i++)
+        if(palette[i].red == color.red && palette[i].green == color.green &&
+           palette[i].blue == color.blue && palette[i].alpha == color.alpha)
+            return i;
+
+    palette.push_back(color);
+    return palette.size()-1;
 }
 
-void Object3D::transform(const Transformation& t){
-    for(auto &face : m_faceList)
-        face.transform(t);
+Mesh::Mesh(const Coordinates& c, const Indices& i, const Faces& f, const Palette& p) :
+    coords(c), indices(i), faces(f), palette(p) {
+    bounds.clear();
+    for(const auto &p : coords){
+        center.x += p.x;
+        center.y += p.y;
+        center.z += p.z;
+        bounds.add(p);
+    }
+
+    int n = coords.size();
+    if(n != 0){
+        center.x /= n;
+        center.y /= n;
+        center.z /= n;
+    }
+}
+
+MeshPtr Object3D::newMesh(const FaceList& faces){
+    Coordinates coords;
+    Indices indices;
+    Faces meshFaces;
+    Palette palette;
+
+    // Vertices iguais são reaproveitados
+    std::map<std::array<double,3>, unsigned> vertices;
+    for(const auto &face : faces){
+        const auto &faceCoords = face.getCoords();
+        meshFaces.push_back(Face{(unsigned) indices.size(),
+                                 (unsigned) faceCoords.size(),
+                                 addToPalette(palette, face.getColor())});
+
+        for(const auto &c : faceCoords){
+            auto iter = vertices.find({{c.x, c.y, c.z}});
+            if(iter != vertices.end()){
+                indices.push_back(iter->second);
+            }else{
+                vertices[{{c.x, c.y, c.z}}] = coords.size();
+                indices.push_back(coords.size());
+                coords.push_back(c);
+            }
+        }
+    }
+
+    return std::make_shared<Mesh>(coords, indices, meshFaces, palette);
 }
 
-void Object3D::transformNormalized(const Transformation& t){
-    for(auto &face : m_faceList)
-        face.transformNormalized(t);
+void Object3D::updateBounds() const{
+    m_localBounds = m_mesh->bounds;
+    m_localCenter = m_mesh->center;
 }
 
-void Surface::transform(const Transformation& t){
-    for(auto &curve : m_curveList)
-        curve.transform(t);
+void Object3D::transformNormalized(const Transformation& t, bool only2D){
+    unsigned size = Object3D::prepareNormalized();
+    Object3D::normalizeRange(fullTransformation(t), only2D, 0, size);
 }
 
-void Surface::transformNormalized(const Transformation& t){
-    for(auto &curve : m_curveList)
-        curve.transformNormalized(t);
+unsigned Object3D::prepareNormalized(){
+    m_nCoords.resize(m_mesh->coords.size());
+    m_regionCodes.resize(m_mesh->coords.size());
+    return m_mesh->coords.size();
 }
 
-void Object::setNCoord(const Coordinates& c){
-    m_nCoords.clear();
-    m_nCoords.insert(m_nCoords.end(), c.begin(), c.end());
+void Object3D::normalizeRange(const Transformation& full, bool only2D,
+                              unsigned first, unsigned size){
+    const Coordinates &coords = m_mesh->coords;
+    if(only2D)
+        Transformation2D(full).apply(coords.data()+first, m_nCoords.data()+first, size);
+    else
+        full.apply(coords.data()+first, m_nCoords.data()+first, size);
 }
 
+void Object3D::bake(){
+    if(!m_hasModel)
+        return;
+
+    Coordinates coords(m_mesh->coords);
+    m_model.apply(coords.data(), coords.data(), coords.size());
+    m_mesh = std::make_shared<Mesh>(coords, m_mesh->indices,
+                                    m_mesh->faces, m_mesh->palette);
+
+    resetModel();
+}
+
+
 void BezierCurve::generateCurve(const Coordinates& cpCoords){
     if(m_controlPoints.size() != 0)
         return;
@@ -323,31 +483,33 @@ void BezierSurface::generateSurface(const Coordinates& cpCoords){
                 double s2 = s * s;
                 double s3 = s2 * s;
 
-                BezierCurve curve("curve"+std::to_string(s), getColor());
+                beginIsoLine();
                 for(float t = 0.0; t <= 1.0; t += m_step){
                     double t2 = t * t;
                     double t3 = t2 * t;
 
-                    curve.addCoordinate(blendingFunction(s,s2,s3,t,t2,t3,nLine,nCol,coords));
+                    addIsoLineCoord(blendingFunction(s,s2,s3,t,t2,t3,nLine,nCol,coords));
                 }
-                m_curveList.insert(m_curveList.end(), curve);
             }
 
             for(float t = 0.0; t <= 1.0; t += m_step){
                 double t2 = t * t;
                 double t3 = t2 * t;
 
-                BezierCurve curve("curve"+std::to_string(t), getColor());
+                beginIsoLine();
                 for(float s = 0.0; s <= 1.0; s += m_step){
                     double s2 = s * s;
                     double s3 = s2 * s;
 
-                    curve.addCoordinate(blendingFunction(s,s2,s3,t,t2,t3,nLine,nCol,coords));
+                    addIsoLineCoord(blendingFunction(s,s2,s3,t,t2,t3,nLine,nCol,coords));
                 }
-                m_curveList.insert(m_curveList.end(), curve);
             }
         }
     }
+
+    // Todas as iso-linhas ficam em um unico vetor, libera a folga do crescimento
+    m_coords.shrink_to_fit();
+    m_isoLines.shrink_to_fit();
 }
 
 Coordinate BezierSurface::blendingFunction(float s, double s2, double s3,
@@ -407,6 +569,10 @@ void BSplineSurface::generateSurface(const Coordinates& cpCoords){
             }
         }
     }
+
+    // Todas as iso-linhas ficam em um unico vetor, libera a folga do crescimento
+    m_coords.shrink_to_fit();
+    m_isoLines.shrink_to_fit();
 }
 
 void BSplineSurface::updateCoordsMatrices(int nLine, int nCol){
@@ -512,15 +678,84 @@ void BSplineSurface::createCurve(double n,
                   double y, double Dy, double D2y, double D3y,
                   double z, double Dz, double D2z, double D3z){
 
-    BSplineCurve curve("curve"+std::to_string(m_curveList.size()), getColor());
-
-    curve.addCoordinate(x,y,z);
+    beginIsoLine();
+    addIsoLineCoord(Coordinate(x,y,z));
     for(int i = 0; i < (n-1); i++){
         x += Dx;  Dx += D2x;  D2x += D3x;
 	    y += Dy;  Dy += D2y;  D2y += D3y;
 	    z += Dz;  Dz += D2z;  D2z += D3z;
 
-	    curve.addCoordinate(x,y,z);
+	    addIsoLineCoord(Coordinate(x,y,z));
+    }
+}
+
+Group::~Group(){
+    // Os filhos passam a usar a matriz do mundo como modelo
+    for(auto obj : m_children){
+        Transformation world = obj->getWorld();
+        obj->m_parent = nullptr;
+        obj->m_model = world;
+        obj->m_hasModel = true;
+        obj->invalidateWorld();
     }
-    m_curveList.push_back(curve);
+}
+
+void Group::addChild(Object* obj){
+    for(Object* p = this; p != nullptr; p = p->m_parent)
+        if(p == obj)
+            throw MyException("Um grupo nao pode conter a si mesmo.\n");
+
+    if(obj->m_parent != nullptr)
+        obj->m_parent->removeChild(obj);
+
+    m_children.push_back(obj);
+    obj->m_parent = this;
+    obj->invalidateWorld();
+    invalidateWorldBounds();
+}
+
+void Group::removeChild(Object* obj){
+    auto iter = std::find(m_children.begin(), m_children.end(), obj);
+    if(iter == m_children.end())
+        return;
+
+    // O filho passa a usar a matriz do mundo como modelo
+    Transformation world = obj->getWorld();
+    m_children.erase(iter);
+    obj->m_parent = nullptr;
+    obj->m_model = world;
+    obj->m_hasModel = true;
+    obj->invalidateWorld();
+    invalidateWorldBounds();
+}
+
+void Group::invalidateWorld(){
+    Object::invalidateWorld();
+    for(auto obj : m_children)
+        obj->invalidateWorld();
+}
+
+void Group::refreshBounds() const{
+    if(!m_worldBoundsDirty)
+        return;
+
+    m_bounds.clear();
+    for(auto obj : m_children)
+        m_bounds.add(obj->bounds());
+
+    m_center = Coordinate((m_bounds.min.x+m_bounds.max.x)/2,
+                          (m_bounds.min.y+m_bounds.max.y)/2,
+                          (m_bounds.min.z+m_bounds.max.z)/2);
+    m_worldBoundsDirty = false;
+}
+
+void Group::bake(){
+    if(m_hasModel){
+        for(auto obj : m_children)
+            obj->transform(m_model);
+        resetModel();
+    }
+
+    for(auto obj : m_children)
+        obj->bake();
 }
@@ -1,4 +1,305 @@
 #include "Transformation.hpp"
+#include "Objects.hpp"
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #include <immintrin.h>
+    #define TRANSFORMATION_SIMD
+#endif
+
+// O kernel le/escreve x, y, z e w direto como 4 doubles seguidos
+static_assert(sizeof(Coordinate) == 4*sizeof(double) && offsetof(Coordinate, x) == 0,
+              "Coordinate precisa ser 4 doubles contiguos");
+#ifndef NCOORDS_DOUBLE
+// ... e x, y e z das coordenadas normalizadas como 3 floats
+static_assert(sizeof(NCoordinate) == 3*sizeof(float) && offsetof(NCoordinate, x) == 0,
+              "NCoordinate precisa ser 3 floats contiguos");
+#endif
+
+namespace {
+
+template<class Out>
+using TransformKernel = void (*)(const tMatrix4x4& m, const Coordinate* in,
+                                 Out* out, std::size_t n);
+using AffineKernel = void (*)(const double (&m)[M_SIZE][M_SIZE-1], const Coordinate* in,
+                              Coordinate* out, std::size_t n);
+template<class Out>
+using Transform2DKernel = void (*)(const double (&m)[3][2], const Coordinate* in,
+                                   Out* out, std::size_t n);
+
+inline void store(Coordinate& out, double x, double y, double z, double w){
+    out.x = x; out.y = y; out.z = z; out.w = w;
+}
+#ifndef NCOORDS_DOUBLE
+// O 'w' não eh guardado nas coordenadas normalizadas
+inline void store(NCoordinate& out, double x, double y, double z, double){
+    out.x = x; out.y = y; out.z = z;
+}
+#endif
+
+// Mesma ordem de operações do Coordinate::operator*=,
+//  então todos os kernels dão o mesmo resultado
+template<class Out>
+void transformScalar(const tMatrix4x4& m, const Coordinate* in,
+                     Out* out, std::size_t n){
+    for(std::size_t i = 0; i < n; i++){
+        double x = in[i].x, y = in[i].y, z = in[i].z, w = in[i].w;
+        store(out[i], x*m[0][0] + y*m[1][0] + z*m[2][0] + w*m[3][0],
+                      x*m[0][1] + y*m[1][1] + z*m[2][1] + w*m[3][1],
+                      x*m[0][2] + y*m[1][2] + z*m[2][2] + w*m[3][2],
+                      x*m[0][3] + y*m[1][3] + z*m[2][3] + w*m[3][3]);
+    }
+}
+
+// Matriz afim [3x4]: o 'w' não eh lido, vale sempre 1, então
+//  a ultima linha da matriz eh apenas somada
+void affineScalar(const double (&m)[M_SIZE][M_SIZE-1], const Coordinate* in,
+                  Coordinate* out, std::size_t n){
+    for(std::size_t i = 0; i < n; i++){
+        double x = in[i].x, y = in[i].y, z = in[i].z;
+        store(out[i], x*m[0][0] + y*m[1][0] + z*m[2][0] + m[3][0],
+                      x*m[0][1] + y*m[1][1] + z*m[2][1] + m[3][1],
+                      x*m[0][2] + y*m[1][2] + z*m[2][2] + m[3][2], 1.0);
+    }
+}
+
+// Ignora o 'z' de entrada [0 para objetos planos] e o 'w' [sempre 1]
+template<class Out>
+void transform2DScalar(const double (&m)[3][2], const Coordinate* in,
+                       Out* out, std::size_t n){
+    for(std::size_t i = 0; i < n; i++){
+        double x = in[i].x, y = in[i].y;
+        store(out[i], x*m[0][0] + y*m[1][0] + m[2][0],
+                      x*m[0][1] + y*m[1][1] + m[2][1], 0.0, 1.0);
+    }
+}
+
+#ifdef TRANSFORMATION_SIMD
+// Cada coordenada eh uma linha: out = x*m[0] + y*m[1] + z*m[2] + w*m[3].
+//  Sem FMA, para não mudar o arredondamento em relação ao escalar
+__attribute__((target("sse2")))
+void transformSSE2(const tMatrix4x4& m, const Coordinate* in,
+                   Coordinate* out, std::size_t n){
+    const __m128d r0a = _mm_loadu_pd(&m[0][0]), r0b = _mm_loadu_pd(&m[0][2]),
+                  r1a = _mm_loadu_pd(&m[1][0]), r1b = _mm_loadu_pd(&m[1][2]),
+                  r2a = _mm_loadu_pd(&m[2][0]), r2b = _mm_loadu_pd(&m[2][2]),
+                  r3a = _mm_loadu_pd(&m[3][0]), r3b = _mm_loadu_pd(&m[3][2]);
+    for(std::size_t i = 0; i < n; i++){
+        const double *c = &in[i].x;
+        __m128d x = _mm_load1_pd(c), y = _mm_load1_pd(c+1),
+                z = _mm_load1_pd(c+2), w = _mm_load1_pd(c+3);
+        __m128d a = _mm_add_pd(_mm_mul_pd(x, r0a), _mm_mul_pd(y, r1a)),
+                b = _mm_add_pd(_mm_mul_pd(x, r0b), _mm_mul_pd(y, r1b));
+        a = _mm_add_pd(_mm_add_pd(a, _mm_mul_pd(z, r2a)), _mm_mul_pd(w, r3a));
+        b = _mm_add_pd(_mm_add_pd(b, _mm_mul_pd(z, r2b)), _mm_mul_pd(w, r3b));
+        _mm_storeu_pd(&out[i].x, a);
+        _mm_storeu_pd(&out[i].z, b);
+    }
+}
+
+__attribute__((target("avx")))
+void transformAVX(const tMatrix4x4& m, const Coordinate* in,
+                  Coordinate* out, std::size_t n){
+    const __m256d r0 = _mm256_loadu_pd(&m[0][0]), r1 = _mm256_loadu_pd(&m[1][0]),
+                  r2 = _mm256_loadu_pd(&m[2][0]), r3 = _mm256_loadu_pd(&m[3][0]);
+    for(std::size_t i = 0; i < n; i++){
+        const double *c = &in[i].x;
+        __m256d x = _mm256_broadcast_sd(c), y = _mm256_broadcast_sd(c+1),
+                z = _mm256_broadcast_sd(c+2), w = _mm256_broadcast_sd(c+3);
+        __m256d r = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, r0), _mm256_mul_pd(y, r1)),
+                                  _mm256_mul_pd(z, r2));
+        r = _mm256_add_pd(r, _mm256_mul_pd(w, r3));
+        _mm256_storeu_pd(&out[i].x, r);
+    }
+}
+
+// Afins: as linhas da matriz 3x4 ganham a 4a coluna (0,0,0,1)
+//  nos registradores, então o 'w' de saida sai 1 da própria soma
+__attribute__((target("sse2")))
+void affineSSE2(const double (&m)[M_SIZE][M_SIZE-1], const Coordinate* in,
+                Coordinate* out, std::size_t n){
+    const __m128d r0a = _mm_loadu_pd(&m[0][0]), r0b = _mm_set_pd(0.0, m[0][2]),
+                  r1a = _mm_loadu_pd(&m[1][0]), r1b = _mm_set_pd(0.0, m[1][2]),
+                  r2a = _mm_loadu_pd(&m[2][0]), r2b = _mm_set_pd(0.0, m[2][2]),
+                  r3a = _mm_loadu_pd(&m[3][0]), r3b = _mm_set_pd(1.0, m[3][2]);
+    for(std::size_t i = 0; i < n; i++){
+        const double *c = &in[i].x;
+        __m128d x = _mm_load1_pd(c), y = _mm_load1_pd(c+1), z = _mm_load1_pd(c+2);
+        __m128d a = _mm_add_pd(_mm_mul_pd(x, r0a), _mm_mul_pd(y, r1a)),
+                b = _mm_add_pd(_mm_mul_pd(x, r0b), _mm_mul_pd(y, r1b));
+        a = _mm_add_pd(_mm_add_pd(a, _mm_mul_pd(z, r2a)), r3a);
+        b = _mm_add_pd(_mm_add_pd(b, _mm_mul_pd(z, r2b)), r3b);
+        _mm_storeu_pd(&out[i].x, a);
+        _mm_storeu_pd(&out[i].z, b);
+    }
+}
+
+__attribute__((target("avx")))
+void affineAVX(const double (&m)[M_SIZE][M_SIZE-1], const Coordinate* in,
+               Coordinate* out, std::size_t n){
+    const __m256d r0 = _mm256_set_pd(0.0, m[0][2], m[0][1], m[0][0]),
+                  r1 = _mm256_set_pd(0.0, m[1][2], m[1][1], m[1][0]),
+                  r2 = _mm256_set_pd(0.0, m[2][2], m[2][1], m[2][0]),
+                  r3 = _mm256_set_pd(1.0, m[3][2], m[3][1], m[3][0]);
+    for(std::size_t i = 0; i < n; i++){
+        const double *c = &in[i].x;
+        __m256d x = _mm256_broadcast_sd(c), y = _mm256_broadcast_sd(c+1),
+                z = _mm256_broadcast_sd(c+2);
+        __m256d r = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, r0), _mm256_mul_pd(y, r1)),
+                                  _mm256_mul_pd(z, r2));
+        _mm256_storeu_pd(&out[i].x, _mm256_add_pd(r, r3));
+    }
+}
+
+#ifndef NCOORDS_DOUBLE
+// Guarda x, y e z [os 3 primeiros floats de 'f']. Escreve 16 bytes
+//  de uma vez, o ultimo float eh sobrescrito pela proxima coordenada;
+//  so a ultima do vetor precisa ser escrita em partes
+__attribute__((target("sse2")))
+inline void storeFloats(NCoordinate* out, std::size_t i, std::size_t n, __m128 f){
+    if(i+1 < n){
+        _mm_storeu_ps(&out[i].x, f);
+    }else{
+        _mm_storel_pi((__m64*) &out[i].x, f);
+        _mm_store_ss(&out[i].z, _mm_movehl_ps(f, f));
+    }
+}
+
+// Calcula em double e converte para float apenas no final
+__attribute__((target("sse2")))
+void transformSSE2ToFloat(const tMatrix4x4& m, const Coordinate* in,
+                          NCoordinate* out, std::size_t n){
+    const __m128d r0a = _mm_loadu_pd(&m[0][0]), r0b = _mm_loadu_pd(&m[0][2]),
+                  r1a = _mm_loadu_pd(&m[1][0]), r1b = _mm_loadu_pd(&m[1][2]),
+                  r2a = _mm_loadu_pd(&m[2][0]), r2b = _mm_loadu_pd(&m[2][2]),
+                  r3a = _mm_loadu_pd(&m[3][0]), r3b = _mm_loadu_pd(&m[3][2]);
+    for(std::size_t i = 0; i < n; i++){
+        const double *c = &in[i].x;
+        __m128d x = _mm_load1_pd(c), y = _mm_load1_pd(c+1),
+                z = _mm_load1_pd(c+2), w = _mm_load1_pd(c+3);
+        __m128d a = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x, r0a), _mm_mul_pd(y, r1a)),
+                                          _mm_mul_pd(z, r2a)), _mm_mul_pd(w, r3a));
+        __m128d b = _mm_add_pd(_mm_add_pd(_mm_add_pd(_mm_mul_pd(x, r0b), _mm_mul_pd(y, r1b)),
+                                          _mm_mul_pd(z, r2b)), _mm_mul_pd(w, r3b));
+        storeFloats(out, i, n, _mm_movelh_ps(_mm_cvtpd_ps(a), _mm_cvtpd_ps(b)));
+    }
+}
+
+__attribute__((target("avx")))
+void transformAVXToFloat(const tMatrix4x4& m, const Coordinate* in,
+                         NCoordinate* out, std::size_t n){
+    const __m256d r0 = _mm256_loadu_pd(&m[0][0]), r1 = _mm256_loadu_pd(&m[1][0]),
+                  r2 = _mm256_loadu_pd(&m[2][0]), r3 = _mm256_loadu_pd(&m[3][0]);
+    for(std::size_t i = 0; i < n; i++){
+        const double *c = &in[i].x;
+        __m256d x = _mm256_broadcast_sd(c), y = _mm256_broadcast_sd(c+1),
+                z = _mm256_broadcast_sd(c+2), w = _mm256_broadcast_sd(c+3);
+        __m256d r = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(x, r0), _mm256_mul_pd(y, r1)),
+                                                _mm256_mul_pd(z, r2)), _mm256_mul_pd(w, r3));
+        storeFloats(out, i, n, _mm256_cvtpd_ps(r));
+    }
+}
+#endif
+
+// x e y em um unico registrador: out = x*m[0] + y*m[1] + m[2]
+__attribute__((target("sse2")))
+inline void store2D(Coordinate* out, std::size_t i, std::size_t, __m128d xy){
+    _mm_storeu_pd(&out[i].x, xy);
+    _mm_storeu_pd(&out[i].z, _mm_set_pd(1.0, 0.0));
+}
+#ifndef NCOORDS_DOUBLE
+__attribute__((target("sse2")))
+inline void store2D(NCoordinate* out, std::size_t i, std::size_t n, __m128d xy){
+    storeFloats(out, i, n, _mm_cvtpd_ps(xy));// z = 0
+}
+#endif
+
+template<class Out>
+__attribute__((target("sse2")))
+void transform2DSSE2(const double (&m)[3][2], const Coordinate* in,
+                     Out* out, std::size_t n){
+    const __m128d r0 = _mm_loadu_pd(m[0]), r1 = _mm_loadu_pd(m[1]),
+                  r2 = _mm_loadu_pd(m[2]);
+    for(std::size_t i = 0; i < n; i++){
+        const double *c = &in[i].x;
+        __m128d r = _mm_add_pd(_mm_add_pd(_mm_mul_pd(_mm_load1_pd(c), r0),
+                                          _mm_mul_pd(_mm_load1_pd(c+1), r1)), r2);
+        store2D(out, i, n, r);
+    }
+}
+#endif
+
+TransformKernel<Coordinate> selectKernel(){
+#ifdef TRANSFORMATION_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx"))
+        return transformAVX;
+    if(__builtin_cpu_supports("sse2"))
+        return transformSSE2;
+#endif
+    return transformScalar<Coordinate>;
+}
+
+AffineKernel selectAffineKernel(){
+#ifdef TRANSFORMATION_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx"))
+        return affineAVX;
+    if(__builtin_cpu_supports("sse2"))
+        return affineSSE2;
+#endif
+    return affineScalar;
+}
+
+#ifndef NCOORDS_DOUBLE
+TransformKernel<NCoordinate> selectFloatKernel(){
+#ifdef TRANSFORMATION_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx"))
+        return transformAVXToFloat;
+    if(__builtin_cpu_supports("sse2"))
+        return transformSSE2ToFloat;
+#endif
+    return transformScalar<NCoordinate>;
+}
+#endif
+
+template<class Out>
+Transform2DKernel<Out> select2DKernel(){
+#ifdef TRANSFORMATION_SIMD
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("sse2"))
+        return transform2DSSE2<Out>;
+#endif
+    return transform2DScalar<Out>;
+}
+
+}
+
+void Transformation::apply(const Coordinate* in, Coordinate* out, std::size_t n) const {
+    // Escolhido uma unica vez, na primeira chamada
+    static const TransformKernel<Coordinate> kernel = selectKernel();
+    kernel(m_matrix, in, out, n);
+}
+
+#ifndef NCOORDS_DOUBLE
+void Transformation::apply(const Coordinate* in, NCoordinate* out, std::size_t n) const {
+    static const TransformKernel<NCoordinate> kernel = selectFloatKernel();
+    kernel(m_matrix, in, out, n);
+}
+#endif
+
+Transformation2D::Transformation2D(const Transformation& t){
+    const auto &m = t.getM();
+    m_matrix[0][0] = m[0][0]; m_matrix[0][1] = m[0][1];
+    m_matrix[1][0] = m[1][0]; m_matrix[1][1] = m[1][1];
+    m_matrix[2][0] = m[3][0]; m_matrix[2][1] = m[3][1];
+}
+
+void Transformation2D::apply(const Coordinate* in, NCoordinate* out, std::size_t n) const {
+    static const Transform2DKernel<NCoordinate> kernel = select2DKernel<NCoordinate>();
+    kernel(m_matrix, in, out, n);
+}
 
 Transformation::Transformation(){
     for(int i=0; i<M_SIZE; i++)
@@ -24,11 +325,17 @@ Transformation Transformation::newScaling(double sx, double sy, double sz){
     return Transformation(m);
 }
 
+Transformation Transformation::newPerspective(double d){
+    tMatrix4x4 m = {{ {1,  0,  0,  0},
+                      {0,  1,  0,  0},
+                      {0,  0,  1, 1/d},
+                      {0,  0,  0,  1}  }};
+    return Transformation(m);
+}
+
 Transformation Transformation::newScalingAroundObjCenter(double sx, double sy, double sz,
                                                         const Coordinate& center){
-    return newTranslation(-center.x, -center.y, -center.z) *
-        newScaling(sx, sy, sz) *
-        newTranslation(center.x, center.y, center.z);
+    return AffineTransformation::newScalingAroundObjCenter(sx, sy, sz, center).toTransformation();
 }
 
 Transformation Transformation::newRx(double angleX, bool isRad){
@@ -58,30 +365,18 @@ Transformation Transformation::newRz(double angleZ, bool isRad){
     return Transformation(m);
 }
 
-//https://www.youtube.com/watch?v=gRVxv8kWl0Q
 Transformation Transformation::newRa(double angleA, const Coordinate& p){
-    // Poupar algum processamento...
-    if(angleA == 0 || (p.x == 0 && p.y == 0 && p.z == 0))
-        return Transformation();
-
-    double d = sqrt(p.y*p.y + p.z*p.z);
-    double beta = atan(p.x/p.z);
-    double alfa = atan(p.y/d);
-
-    return Transformation::newTranslation(-p.x, -p.y, -p.z) * Transformation::newRy(-beta,true) *
-        Transformation::newRx(alfa,true) * Transformation::newRz(angleA) *
-        Transformation::newRx(-alfa,true) * Transformation::newRy(beta,true) *
-        Transformation::newTranslation(p.x, p.y, p.z);
+    return Quaternion::newAxisAngle(angleA, p).toTransformation();
 }
 
 Transformation Transformation::newRotation(double angleX, double angleY, double angleZ){
-    return newRx(angleX) * newRy(angleY) * newRz(angleZ);
+    return Quaternion::newRotation(angleX, angleY, angleZ).toTransformation();
 }
 
 Transformation Transformation::newFullRotation(double angleX, double angleY,
                                     double angleZ, double angleA, const Coordinate& p){
-    return newRx(angleX) * newRy(angleY) *
-        newRz(angleZ) * newRa(angleA, p);
+    return (Quaternion::newRotation(angleX, angleY, angleZ) *
+            Quaternion::newAxisAngle(angleA, p)).toTransformation();
 }
 
 Transformation& Transformation::operator*=(const Transformation& t2){
@@ -121,3 +416,116 @@ std::ostream& operator<<(std::ostream& os, const Transformation& t){
     }
     return os;
 }
+
+Transformation AffineTransformation::toTransformation() const {
+    const auto &m = m_matrix;
+    tMatrix4x4 t = {{ {m[0][0], m[0][1], m[0][2], 0},
+                      {m[1][0], m[1][1], m[1][2], 0},
+                      {m[2][0], m[2][1], m[2][2], 0},
+                      {m[3][0], m[3][1], m[3][2], 1}  }};
+    return Transformation(t);
+}
+
+void AffineTransformation::apply(const Coordinate* in, Coordinate* out, std::size_t n) const {
+    // Direto na matriz 3x4, sem passar pela 4x4
+    static const AffineKernel kernel = selectAffineKernel();
+    kernel(m_matrix, in, out, n);
+}
+
+AffineTransformation& AffineTransformation::operator*=(const AffineTransformation& t2){
+    *this = *this * t2;
+    return *this;
+}
+
+AffineTransformation AffineTransformation::newRx(double angleX, bool isRad){
+    double rad = isRad ? angleX : Transformation::toRadians(angleX);
+    return AffineTransformation(1, 0,         0,
+                                0, cos(rad),  sin(rad),
+                                0, -sin(rad), cos(rad),
+                                0, 0,         0);
+}
+
+AffineTransformation AffineTransformation::newRy(double angleY, bool isRad){
+    double rad = isRad ? angleY : Transformation::toRadians(angleY);
+    return AffineTransformation(cos(rad), 0, -sin(rad),
+                                0,        1, 0,
+                                sin(rad), 0, cos(rad),
+                                0,        0, 0);
+}
+
+AffineTransformation AffineTransformation::newRz(double angleZ, bool isRad){
+    double rad = isRad ? angleZ : Transformation::toRadians(angleZ);
+    return AffineTransformation(cos(rad),  sin(rad), 0,
+                                -sin(rad), cos(rad), 0,
+                                0,         0,        1,
+                                0,         0,        0);
+}
+
+// Eixo que passa pela origem e por 'p' [p continua fixo]
+AffineTransformation AffineTransformation::newRa(double angleA, const Coordinate& p){
+    return Quaternion::newAxisAngle(angleA, p).toAffine();
+}
+
+AffineTransformation AffineTransformation::newRotation(double angleX, double angleY, double angleZ){
+    return Quaternion::newRotation(angleX, angleY, angleZ).toAffine();
+}
+
+AffineTransformation AffineTransformation::newScalingAroundObjCenter(double sx, double sy, double sz,
+                                                                    const Coordinate& center){
+    return newTranslation(-center.x, -center.y, -center.z) *
+        newScaling(sx, sy, sz) *
+        newTranslation(center.x, center.y, center.z);
+}
+
+Quaternion& Quaternion::normalize(){
+    double n = sqrt(w*w + x*x + y*y + z*z);
+    if(n != 0){
+        w /= n; x /= n; y /= n; z /= n;
+    }
+    return *this;
+}
+
+// Produto de Hamilton q2*q1: em quaternions quem aplica
+//  primeiro fica a direita, nas matrizes [linha] a esquerda
+Quaternion& Quaternion::operator*=(const Quaternion& q2){
+    const Quaternion q1 = *this;
+    w = q2.w*q1.w - q2.x*q1.x - q2.y*q1.y - q2.z*q1.z;
+    x = q2.w*q1.x + q2.x*q1.w + q2.y*q1.z - q2.z*q1.y;
+    y = q2.w*q1.y - q2.x*q1.z + q2.y*q1.w + q2.z*q1.x;
+    z = q2.w*q1.z + q2.x*q1.y - q2.y*q1.x + q2.z*q1.w;
+    return *this;
+}
+
+Quaternion operator*(Quaternion q1, const Quaternion& q2){
+    q1 *= q2;
+    return q1;
+}
+
+// Transposta da matriz de rotação usual, pois as coordenadas
+//  aqui são vetores linha
+AffineTransformation Quaternion::toAffine() const {
+    double xx = x*x, yy = y*y, zz = z*z,
+           xy = x*y, xz = x*z, yz = y*z,
+           wx = w*x, wy = w*y, wz = w*z;
+    return AffineTransformation(1 - 2*(yy + zz), 2*(xy + wz),     2*(xz - wy),
+                                2*(xy - wz),     1 - 2*(xx + zz), 2*(yz + wx),
+                                2*(xz + wy),     2*(yz - wx),     1 - 2*(xx + yy),
+                                0,               0,               0);
+}
+
+Quaternion Quaternion::newAxisAngle(double angle, const Coordinate& axis, bool isRad){
+    double rad = isRad ? angle : Transformation::toRadians(angle);
+    double n = sqrt(axis.x*axis.x + axis.y*axis.y + axis.z*axis.z);
+    // Poupar algum processamento...
+    if(rad == 0 || n == 0)
+        return Quaternion();
+
+    double s = sin(rad/2)/n;
+    return Quaternion(cos(rad/2), axis.x*s, axis.y*s, axis.z*s);
+}
+
+Quaternion Quaternion::newRotation(double angleX, double angleY, double angleZ){
+    return newAxisAngle(angleX, Coordinate(1,0,0)) *
+        newAxisAngle(angleY, Coordinate(0,1,0)) *
+        newAxisAngle(angleZ, Coordinate(0,0,1));
+}
@@ -0,0 +1,103 @@
+#include <gtk/gtk.h>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "World.hpp"
+#include "Viewport.hpp"
+#include "FileHandlers.hpp"
+
+/*
+    Conta as chamadas do operator new [substituido abaixo]
+     durante redesenhos repetidos de uma cena fixa. Depois
+     do aquecimento, nenhum quadro deve alocar: os temporarios
+     vem da FrameArena de cada Clipping e os demais buffers
+     reaproveitam a capacidade do quadro anterior.
+
+    Rodar com 'make test' a partir da pasta da Etapa.
+*/
+
+static long g_allocs = 0;
+
+void* operator new(std::size_t size){
+    g_allocs++;
+    void* p = std::malloc(size != 0 ? size : 1);
+    if(p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+static void loadFile(World* world, Viewport* viewport, std::string file){
+    ObjReader r(file);
+    for(auto obj : r.getObjs()){
+        world->addObj(obj);
+        viewport->transformAndClipObj(obj);
+    }
+}
+
+// Gira e anda com a window nos quadros pares e desfaz o
+//  movimento nos impares: a cada 2 quadros a cena se repete
+static void frame(Viewport* viewport, cairo_t* cr, int i){
+    if(i%2 == 0){
+        viewport->rotateWindow(10, "z");
+        viewport->moveWindow(3.0, 1.0);
+    }else{
+        viewport->moveWindow(-3.0, -1.0);
+        viewport->rotateWindow(-10, "z");
+    }
+    viewport->drawObjs(cr);
+}
+
+int main(){
+    cairo_surface_t* surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, 500, 500);
+    cairo_t* cr = cairo_create(surface);
+
+    World world;
+    Viewport viewport(500, 500, &world);
+    loadFile(&world, &viewport, "objs/allObjs.obj");
+    loadFile(&world, &viewport, "objs/bowler.obj");
+    // Grande o suficiente para cruzar a borda da window
+    world.scaleObj("Line04", 150.0, 150.0, 150.0);
+
+    const LineClipAlgs lineAlgs[] = { LineClipAlgs::CS, LineClipAlgs::LB,
+                                      LineClipAlgs::NLN, LineClipAlgs::AUTO };
+    const PolygonClipAlgs polyAlgs[] = { PolygonClipAlgs::SH, PolygonClipAlgs::SHR };
+    const int frames = 40;
+    int failures = 0;
+
+    for(unsigned threads : {1u, 3u})
+    for(bool guardBand : {false, true})
+    for(auto lineAlg : lineAlgs)
+    for(auto polyAlg : polyAlgs){
+        viewport.setThreads(threads);
+        viewport.setGuardBand(guardBand);
+        viewport.changeLineClipAlg(lineAlg);
+        viewport.changePolygonClipAlg(polyAlg);
+
+        // Aquecimento: arenas e vetores chegam ao tamanho do quadro
+        for(int i = 0; i < 8; i++)
+            frame(&viewport, cr, i);
+
+        long before = g_allocs;
+        for(int i = 0; i < frames; i++)
+            frame(&viewport, cr, i);
+        long allocs = g_allocs - before;
+
+        printf("threads=%u guard=%d line=%d poly=%d: %ld alocacoes em %d quadros\n",
+               threads, guardBand, (int) lineAlg, (int) polyAlg, allocs, frames);
+        if(allocs != 0)
+            failures++;
+    }
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+
+    if(failures != 0){
+        printf("FALHOU: %d configuracao(oes) alocaram durante o desenho\n", failures);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}